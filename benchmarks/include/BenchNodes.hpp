@@ -0,0 +1,191 @@
+#pragma once
+
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/NodeData>
+#include <QtNodes/NodeDelegateModel>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::ExecutionPlan;
+using QtNodes::NodeData;
+using QtNodes::NodeDataType;
+using QtNodes::NodeDelegateModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
+using QtNodes::PortIndex;
+using QtNodes::PortType;
+
+// Payload passed between benchmark nodes.
+class BenchData : public NodeData
+{
+public:
+    BenchData(double value = 0.0)
+        : _value(value)
+    {}
+
+    NodeDataType type() const override { return NodeDataType{"BenchData", "Bench Data"}; }
+
+    double value() const { return _value; }
+
+private:
+    double _value;
+};
+
+// Node with two inputs and one output forwarding the sum of its inputs.
+class BenchPassThroughNode : public NodeDelegateModel
+{
+public:
+    QString caption() const override { return "Pass Through"; }
+    QString name() const override { return Name(); }
+    static QString Name() { return "BenchPassThroughNode"; }
+
+    unsigned int nPorts(PortType portType) const override
+    {
+        return (portType == PortType::In) ? 2 : 1;
+    }
+
+    NodeDataType dataType(PortType, PortIndex) const override { return BenchData{}.type(); }
+
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const portIndex) override
+    {
+        _inputs[portIndex] = std::dynamic_pointer_cast<BenchData>(data);
+
+        double sum = 0.0;
+        for (auto const &input : _inputs) {
+            if (input)
+                sum += input->value();
+        }
+
+        _result = std::make_shared<BenchData>(sum);
+
+        Q_EMIT dataUpdated(0);
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const) override { return _result; }
+
+    QWidget *embeddedWidget() override { return nullptr; }
+
+private:
+    std::shared_ptr<BenchData> _inputs[2];
+
+    std::shared_ptr<BenchData> _result = std::make_shared<BenchData>();
+};
+
+inline std::shared_ptr<NodeDelegateModelRegistry> benchRegistry()
+{
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<BenchPassThroughNode>("Bench");
+    return registry;
+}
+
+/// Builds a linear chain of `nodeCount` nodes connected output 0 -> input 0.
+inline std::vector<NodeId> buildChain(DataFlowGraphModel &model, std::size_t nodeCount)
+{
+    std::vector<NodeId> nodes;
+    nodes.reserve(nodeCount);
+
+    for (std::size_t i = 0; i < nodeCount; ++i) {
+        nodes.push_back(model.addNode(BenchPassThroughNode::Name()));
+
+        if (i > 0)
+            model.addConnection(ConnectionId{nodes[i - 1], 0, nodes[i], 0});
+    }
+
+    return nodes;
+}
+
+/// One source whose output feeds input 0 of all other `nodeCount - 1` nodes.
+inline std::vector<NodeId> buildFan(DataFlowGraphModel &model, std::size_t nodeCount)
+{
+    std::vector<NodeId> nodes;
+    nodes.reserve(nodeCount);
+
+    for (std::size_t i = 0; i < nodeCount; ++i) {
+        nodes.push_back(model.addNode(BenchPassThroughNode::Name()));
+
+        if (i > 0)
+            model.addConnection(ConnectionId{nodes[0], 0, nodes[i], 0});
+    }
+
+    return nodes;
+}
+
+/// Diamonds `top -> {left, right} -> bottom` in a row, each bottom being the
+/// next top. Builds at most `nodeCount` nodes.
+inline std::vector<NodeId> buildDiamonds(DataFlowGraphModel &model, std::size_t nodeCount)
+{
+    std::vector<NodeId> nodes;
+    nodes.reserve(nodeCount);
+
+    if (nodeCount == 0)
+        return nodes;
+
+    nodes.push_back(model.addNode(BenchPassThroughNode::Name()));
+
+    while (nodes.size() + 3 <= nodeCount) {
+        NodeId const top = nodes.back();
+        NodeId const left = model.addNode(BenchPassThroughNode::Name());
+        NodeId const right = model.addNode(BenchPassThroughNode::Name());
+        NodeId const bottom = model.addNode(BenchPassThroughNode::Name());
+
+        model.addConnection(ConnectionId{top, 0, left, 0});
+        model.addConnection(ConnectionId{top, 0, right, 0});
+        model.addConnection(ConnectionId{left, 0, bottom, 0});
+        model.addConnection(ConnectionId{right, 0, bottom, 1});
+
+        nodes.push_back(left);
+        nodes.push_back(right);
+        nodes.push_back(bottom);
+    }
+
+    return nodes;
+}
+
+/// Every node but the first takes both inputs from random earlier nodes.
+/// The same `seed` always yields the same graph.
+inline std::vector<NodeId> buildRandomDag(DataFlowGraphModel &model,
+                                          std::size_t nodeCount,
+                                          std::uint32_t seed = 42)
+{
+    std::mt19937 generator(seed);
+
+    std::vector<NodeId> nodes;
+    nodes.reserve(nodeCount);
+
+    for (std::size_t i = 0; i < nodeCount; ++i) {
+        nodes.push_back(model.addNode(BenchPassThroughNode::Name()));
+
+        if (i == 0)
+            continue;
+
+        std::uniform_int_distribution<std::size_t> earlier(0, i - 1);
+
+        for (PortIndex portIndex = 0; portIndex < 2; ++portIndex)
+            model.addConnection(ConnectionId{nodes[earlier(generator)], 0, nodes[i], portIndex});
+    }
+
+    return nodes;
+}
+
+/// A named graph generator, see `graphShapes()`.
+struct GraphShape
+{
+    char const *name;
+    std::vector<NodeId> (*build)(DataFlowGraphModel &, std::size_t);
+};
+
+inline std::vector<GraphShape> graphShapes()
+{
+    return {{"chain", &buildChain},
+            {"fan", &buildFan},
+            {"diamonds", &buildDiamonds},
+            {"random DAG", [](DataFlowGraphModel &model, std::size_t nodeCount) {
+                 return buildRandomDag(model, nodeCount);
+             }}};
+}
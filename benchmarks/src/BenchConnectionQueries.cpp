@@ -0,0 +1,45 @@
+#include "BenchNodes.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+// The graph sizes are chosen so that a linear-time query would show a clear
+// 20x spread between the smallest and the largest graph.
+static std::size_t const GraphSizes[] = {1000, 5000, 20000};
+
+TEST_CASE("Connection queries scale with port degree", "[benchmark][connections]")
+{
+    for (std::size_t const nodeCount : GraphSizes) {
+        DataFlowGraphModel model(benchRegistry());
+
+        auto const nodes = buildChain(model, nodeCount);
+
+        NodeId const middle = nodes[nodes.size() / 2];
+
+        std::string const suffix = " (" + std::to_string(nodeCount - 1) + " edges)";
+
+        BENCHMARK("connections() single port" + suffix)
+        {
+            return model.connections(middle, PortType::Out, 0).size();
+        };
+
+        BENCHMARK("allConnectionIds() single node" + suffix)
+        {
+            return model.allConnectionIds(middle).size();
+        };
+
+        // Mirrors what painting and NodeGraphicsObject::moveConnections() do:
+        // every port of every node is queried once.
+        BENCHMARK("connections() all ports" + suffix)
+        {
+            std::size_t total = 0;
+            for (NodeId const nodeId : nodes) {
+                total += model.connections(nodeId, PortType::In, 0).size();
+                total += model.connections(nodeId, PortType::In, 1).size();
+                total += model.connections(nodeId, PortType::Out, 0).size();
+            }
+            return total;
+        };
+    }
+}
@@ -0,0 +1,51 @@
+#include "BenchNodes.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <QUndoStack>
+
+#include <string>
+
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::NodeRole;
+
+TEST_CASE("Dragging a large selection", "[benchmark][drag]")
+{
+    for (std::size_t const nodeCount : {100, 1000}) {
+        DataFlowGraphModel model(benchRegistry());
+        DataFlowGraphicsScene scene(model);
+
+        std::vector<NodeId> const nodes = buildChain(model, nodeCount);
+
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            model.setNodeData(nodes[i], NodeRole::Position, QPointF(double(i) * 200.0, 0.0));
+            scene.nodeGraphicsObject(nodes[i])->setSelected(true);
+        }
+
+        std::string const suffix = " (" + std::to_string(nodeCount) + " selected)";
+
+        scene.beginNodeDrag();
+
+        BENCHMARK("dragNodes() step" + suffix)
+        {
+            scene.dragNodes(QPointF(1, 0));
+        };
+
+        scene.endNodeDrag();
+
+        BENCHMARK("Whole gesture, 60 steps" + suffix)
+        {
+            scene.beginNodeDrag();
+
+            for (int step = 0; step < 60; ++step)
+                scene.dragNodes(QPointF(1, 0));
+
+            scene.endNodeDrag();
+
+            return scene.undoStack().count();
+        };
+    }
+}
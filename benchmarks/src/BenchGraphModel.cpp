@@ -0,0 +1,91 @@
+#include "BenchNodes.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <string>
+
+static std::size_t const GraphSizes[] = {1000, 10000, 100000};
+
+static std::string sizeSuffix(GraphShape const &shape, std::size_t const nodeCount)
+{
+    return " (" + std::string(shape.name) + ", " + std::to_string(nodeCount) + " nodes)";
+}
+
+TEST_CASE("Graph construction", "[benchmark][model]")
+{
+    auto const registry = benchRegistry();
+
+    for (std::size_t const nodeCount : GraphSizes) {
+        for (GraphShape const &shape : graphShapes()) {
+            // Only addNode() and addConnection() are timed, not the model's
+            // construction and destruction.
+            BENCHMARK_ADVANCED("addNode() + addConnection()" + sizeSuffix(shape, nodeCount))
+            (Catch::Benchmark::Chronometer meter)
+            {
+                std::vector<std::unique_ptr<DataFlowGraphModel>> models;
+                for (int i = 0; i < meter.runs(); ++i)
+                    models.push_back(std::make_unique<DataFlowGraphModel>(registry));
+
+                meter.measure(
+                    [&](int const i) { return shape.build(*models[i], nodeCount).size(); });
+            };
+        }
+    }
+}
+
+TEST_CASE("Connection checks", "[benchmark][model]")
+{
+    for (std::size_t const nodeCount : GraphSizes) {
+        DataFlowGraphModel model(benchRegistry());
+
+        auto const nodes = buildChain(model, nodeCount);
+
+        std::string const suffix = " (" + std::to_string(nodeCount) + " nodes)";
+
+        // Input 1 of every chain node is free.
+        ConnectionId const forward{nodes.front(), 0, nodes.back(), 1};
+        ConnectionId const backward{nodes.back(), 0, nodes.front(), 1};
+
+        BENCHMARK("connectionPossible() along the order" + suffix)
+        {
+            return model.connectionPossible(forward);
+        };
+
+        BENCHMARK("connectionPossible() closing a cycle" + suffix)
+        {
+            return model.connectionPossible(backward);
+        };
+    }
+}
+
+TEST_CASE("Data propagation", "[benchmark][model]")
+{
+    for (std::size_t const nodeCount : GraphSizes) {
+        for (GraphShape const &shape : graphShapes()) {
+            DataFlowGraphModel model(benchRegistry());
+
+            auto const nodes = shape.build(model, nodeCount);
+
+            // The first node of every shape has no incoming connections.
+            auto source = model.delegateModel<BenchPassThroughNode>(nodes.front());
+
+            double value = 0.0;
+
+            BENCHMARK("propagate from the first node" + sizeSuffix(shape, nodeCount))
+            {
+                value += 1.0;
+                source->setInData(std::make_shared<BenchData>(value), 1);
+            };
+
+            ExecutionPlan plan = model.compile();
+
+            BENCHMARK("run the compiled plan" + sizeSuffix(shape, nodeCount))
+            {
+                value += 1.0;
+                plan.setSourceData(nodes.front(), 0, std::make_shared<BenchData>(value));
+                return plan.run();
+            };
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include "BenchNodes.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/internal/SceneSpatialIndex.hpp>
+#include <QtNodes/internal/locateNode.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <string>
+
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::NodeRole;
+using QtNodes::SceneSpatialIndex;
+
+// Nodes are laid out on a square lattice, 200 scene units apart.
+static QPointF latticePosition(std::size_t const i, std::size_t const count)
+{
+    auto const side = static_cast<std::size_t>(std::ceil(std::sqrt(double(count))));
+
+    return QPointF(double(i % side) * 200.0, double(i / side) * 200.0);
+}
+
+TEST_CASE("Spatial index queries stay flat", "[benchmark][hittest]")
+{
+    for (std::size_t const nodeCount : {1000, 10000, 100000}) {
+        SceneSpatialIndex index;
+
+        for (std::size_t i = 0; i < nodeCount; ++i)
+            index.updateNode(NodeId(i), QRectF(latticePosition(i, nodeCount), QSizeF(150, 80)));
+
+        QPointF const probe = latticePosition(nodeCount / 2, nodeCount) + QPointF(10, 10);
+
+        std::string const suffix = " (" + std::to_string(nodeCount) + " nodes)";
+
+        BENCHMARK("nodesAt()" + suffix)
+        {
+            return index.nodesAt(probe).size();
+        };
+
+        BENCHMARK("nodesIn() viewport" + suffix)
+        {
+            return index.nodesIn(QRectF(probe, QSizeF(1920, 1080))).size();
+        };
+
+        NodeId moved = NodeId(nodeCount / 2);
+        QPointF offset(0, 0);
+
+        BENCHMARK("updateNode() drag step" + suffix)
+        {
+            offset += QPointF(1, 0);
+            index.updateNode(moved, QRectF(probe + offset, QSizeF(150, 80)));
+        };
+    }
+}
+
+TEST_CASE("Node lookup under the cursor", "[benchmark][hittest]")
+{
+    for (std::size_t const nodeCount : {1000, 10000}) {
+        DataFlowGraphModel model(benchRegistry());
+        DataFlowGraphicsScene scene(model);
+
+        for (std::size_t i = 0; i < nodeCount; ++i) {
+            NodeId const nodeId = model.addNode("BenchPassThroughNode");
+            model.setNodeData(nodeId, NodeRole::Position, latticePosition(i, nodeCount));
+        }
+
+        QPointF const probe = latticePosition(nodeCount / 2, nodeCount) + QPointF(10, 10);
+
+        BENCHMARK("locateNodeAt() (" + std::to_string(nodeCount) + " nodes)")
+        {
+            return QtNodes::locateNodeAt(probe, scene, QTransform());
+        };
+    }
+}
@@ -0,0 +1,83 @@
+#include "BenchNodes.hpp"
+
+#include <QtNodes/ConnectionStyle>
+#include <QtNodes/DataFlowGraphicsScene>
+
+#include <catch2/catch.hpp>
+
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+
+#include <string>
+
+using QtNodes::ConnectionStyle;
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::NodeRole;
+
+// Accepts BenchData and emits another type, so every connection between two
+// of these nodes is drawn as a type-converting one.
+class BenchConvertNode : public BenchPassThroughNode
+{
+public:
+    QString name() const override { return Name(); }
+    static QString Name() { return "BenchConvertNode"; }
+
+    NodeDataType dataType(PortType portType, PortIndex) const override
+    {
+        if (portType == PortType::Out)
+            return NodeDataType{"BenchConverted", "Bench Converted"};
+
+        return BenchData{}.type();
+    }
+};
+
+static void renderChain(QString const &nodeName, std::size_t const nodeCount)
+{
+    auto registry = benchRegistry();
+    registry->registerModel<BenchConvertNode>("Bench");
+
+    DataFlowGraphModel model(registry);
+    DataFlowGraphicsScene scene(model);
+
+    NodeId previous = QtNodes::InvalidNodeId;
+
+    for (std::size_t i = 0; i < nodeCount; ++i) {
+        NodeId const nodeId = model.addNode(nodeName);
+        model.setNodeData(nodeId,
+                          NodeRole::Position,
+                          QPointF(double(i % 10) * 250.0, double(i / 10) * 150.0));
+
+        if (previous != QtNodes::InvalidNodeId)
+            model.addConnection(ConnectionId{previous, 0, nodeId, 0});
+
+        previous = nodeId;
+    }
+
+    QImage image(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+
+    BENCHMARK("render " + std::to_string(nodeCount) + " x " + nodeName.toStdString())
+    {
+        image.fill(Qt::white);
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        scene.render(&painter);
+    };
+}
+
+TEST_CASE("Connection painting", "[benchmark][painting]")
+{
+    ConnectionStyle::setConnectionStyle(R"(
+  {
+    "ConnectionStyle": {
+      "UseDataDefinedColors": true
+    }
+  }
+  )");
+
+    renderChain(BenchPassThroughNode::Name(), 100);
+    renderChain(BenchConvertNode::Name(), 100);
+
+    // Restore the default style for the remaining benchmarks.
+    ConnectionStyle::setConnectionStyle("{}");
+}
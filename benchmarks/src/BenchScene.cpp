@@ -0,0 +1,84 @@
+#include "BenchNodes.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+
+#include <catch2/catch.hpp>
+
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::NodeRole;
+
+static std::size_t const GraphSizes[] = {1000, 10000};
+
+// Spreads the nodes over a square lattice, 250 x 150 scene units apart.
+static void layOut(DataFlowGraphModel &model, std::vector<NodeId> const &nodes)
+{
+    auto const side = static_cast<std::size_t>(std::ceil(std::sqrt(double(nodes.size()))));
+
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        model.setNodeData(nodes[i],
+                          NodeRole::Position,
+                          QPointF(double(i % side) * 250.0, double(i / side) * 150.0));
+    }
+}
+
+TEST_CASE("Scene population", "[benchmark][scene]")
+{
+    for (std::size_t const nodeCount : GraphSizes) {
+        DataFlowGraphModel model(benchRegistry());
+        layOut(model, buildRandomDag(model, nodeCount));
+
+        // Tearing the scenes down is not timed.
+        BENCHMARK_ADVANCED("populate scene (" + std::to_string(nodeCount) + " nodes)")
+        (Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<std::unique_ptr<DataFlowGraphicsScene>> scenes(meter.runs());
+
+            meter.measure([&](int const i) {
+                scenes[i] = std::make_unique<DataFlowGraphicsScene>(model);
+                return scenes[i]->items().size();
+            });
+        };
+    }
+}
+
+TEST_CASE("Scene repaint", "[benchmark][scene]")
+{
+    for (std::size_t const nodeCount : GraphSizes) {
+        DataFlowGraphModel model(benchRegistry());
+        DataFlowGraphicsScene scene(model);
+        layOut(model, buildRandomDag(model, nodeCount));
+
+        std::string const suffix = " (" + std::to_string(nodeCount) + " nodes)";
+
+        QImage image(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+
+        // A full HD window at 100% zoom over the middle of the graph.
+        QRectF const viewport(scene.itemsBoundingRect().center() - QPointF(960, 540),
+                              QSizeF(1920, 1080));
+
+        BENCHMARK("repaint viewport" + suffix)
+        {
+            image.fill(Qt::white);
+
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::Antialiasing);
+            scene.render(&painter, QRectF(image.rect()), viewport);
+        };
+
+        BENCHMARK("repaint whole scene" + suffix)
+        {
+            image.fill(Qt::white);
+
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::Antialiasing);
+            scene.render(&painter);
+        };
+    }
+}
@@ -0,0 +1,61 @@
+#include "BenchNodes.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QJsonDocument>
+
+#include <string>
+
+static std::size_t const GraphSizes[] = {1000, 10000, 50000};
+
+TEST_CASE("JSON and binary serialization", "[benchmark][serialization]")
+{
+    for (std::size_t const nodeCount : GraphSizes) {
+        DataFlowGraphModel model(benchRegistry());
+        buildChain(model, nodeCount);
+
+        std::string const suffix = " (" + std::to_string(nodeCount) + " nodes)";
+
+        QByteArray const json = QJsonDocument(model.save()).toJson();
+
+        QBuffer binaryBuffer;
+        binaryBuffer.open(QIODevice::WriteOnly);
+        model.saveBinary(binaryBuffer);
+        QByteArray const binary = binaryBuffer.data();
+
+        WARN("Encoded size" << suffix << ": JSON " << json.size() << " bytes, binary "
+                            << binary.size() << " bytes");
+
+        BENCHMARK("save JSON" + suffix)
+        {
+            return QJsonDocument(model.save()).toJson().size();
+        };
+
+        BENCHMARK("save binary" + suffix)
+        {
+            QBuffer buffer;
+            buffer.open(QIODevice::WriteOnly);
+            model.saveBinary(buffer);
+            return buffer.size();
+        };
+
+        BENCHMARK("load JSON" + suffix)
+        {
+            DataFlowGraphModel loaded(benchRegistry());
+            loaded.load(QJsonDocument::fromJson(json).object());
+            return loaded.allNodeIds().size();
+        };
+
+        BENCHMARK("load binary" + suffix)
+        {
+            QBuffer buffer;
+            buffer.setData(binary);
+            buffer.open(QIODevice::ReadOnly);
+
+            DataFlowGraphModel loaded(benchRegistry());
+            loaded.loadBinary(buffer);
+            return loaded.allNodeIds().size();
+        };
+    }
+}
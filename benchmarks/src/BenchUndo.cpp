@@ -0,0 +1,33 @@
+#include "BenchNodes.hpp"
+
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/UndoCommands>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <QUndoStack>
+
+#include <string>
+
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DeleteCommand;
+
+TEST_CASE("Undoing a large deletion", "[benchmark][undo]")
+{
+    for (std::size_t const nodeCount : {100, 1000}) {
+        DataFlowGraphModel model(benchRegistry());
+        DataFlowGraphicsScene scene(model);
+
+        for (NodeId const nodeId : buildChain(model, nodeCount))
+            scene.nodeGraphicsObject(nodeId)->setSelected(true);
+
+        scene.undoStack().push(new DeleteCommand(&scene));
+
+        BENCHMARK("undo() + redo() (" + std::to_string(nodeCount) + " nodes)")
+        {
+            scene.undoStack().undo();
+            scene.undoStack().redo();
+        };
+    }
+}
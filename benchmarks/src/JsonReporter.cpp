@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string jsonString(std::string const &s)
+{
+    std::ostringstream out;
+    out << '"';
+
+    for (char const c : s) {
+        switch (c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c)
+                    << std::dec;
+            else
+                out << c;
+        }
+    }
+
+    out << '"';
+    return out.str();
+}
+
+/**
+ * Machine-readable benchmark results, selected with `-r json`.
+ *
+ * Writes one object per BENCHMARK with the mean, its confidence bounds and the
+ * standard deviation in nanoseconds. Benchmarks that threw are listed under
+ * "failures". Test assertions are not reported.
+ */
+class JsonReporter : public Catch::StreamingReporterBase<JsonReporter>
+{
+public:
+    using StreamingReporterBase::StreamingReporterBase;
+
+    static std::string getDescription()
+    {
+        return "Reports benchmark results as a JSON document";
+    }
+
+    void assertionStarting(Catch::AssertionInfo const &) override {}
+
+    bool assertionEnded(Catch::AssertionStats const &) override { return true; }
+
+    void benchmarkPreparing(std::string const &name) override { _benchmarkName = name; }
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const &stats) override
+    {
+        std::ostringstream out;
+        out << std::setprecision(10);
+
+        out << "    {\"test_case\": " << jsonString(currentTestCaseInfo->name)
+            << ", \"tags\": " << jsonString(currentTestCaseInfo->tagsAsString())
+            << ", \"name\": " << jsonString(stats.info.name)
+            << ", \"samples\": " << stats.info.samples
+            << ", \"iterations\": " << stats.info.iterations
+            << ", \"mean_ns\": " << stats.mean.point.count()
+            << ", \"mean_lower_ns\": " << stats.mean.lower_bound.count()
+            << ", \"mean_upper_ns\": " << stats.mean.upper_bound.count()
+            << ", \"std_dev_ns\": " << stats.standardDeviation.point.count()
+            << ", \"outlier_variance\": " << stats.outlierVariance << "}";
+
+        _results.push_back(out.str());
+    }
+
+    void benchmarkFailed(std::string const &error) override
+    {
+        _failures.push_back("    {\"name\": " + jsonString(_benchmarkName)
+                            + ", \"error\": " + jsonString(error) + "}");
+    }
+
+    void testRunEnded(Catch::TestRunStats const &testRunStats) override
+    {
+        stream << "{\n  \"run\": " << jsonString(testRunStats.runInfo.name) << ",\n";
+
+        writeArray("benchmarks", _results);
+        stream << ",\n";
+        writeArray("failures", _failures);
+
+        stream << "\n}\n";
+
+        StreamingReporterBase::testRunEnded(testRunStats);
+    }
+
+private:
+    void writeArray(char const *key, std::vector<std::string> const &items)
+    {
+        stream << "  \"" << key << "\": [";
+
+        for (std::size_t i = 0; i < items.size(); ++i)
+            stream << (i == 0 ? "\n" : ",\n") << items[i];
+
+        stream << (items.empty() ? "]" : "\n  ]");
+    }
+
+private:
+    std::string _benchmarkName;
+
+    std::vector<std::string> _results;
+
+    std::vector<std::string> _failures;
+};
+
+} // namespace
+
+CATCH_REGISTER_REPORTER("json", JsonReporter)
@@ -24,6 +24,8 @@ public:
 
     QString numberAsText() const { return QString::number(_number, 'f'); }
 
+    QJsonValue toJson() const override { return _number; }
+
 private:
     double _number;
 };
@@ -1,36 +1,27 @@
 #pragma once
 
 #include <QtNodes/NodeDelegateModel>
-#include <QTimer>
 #include <QtCore/QObject>
-#include <QtWidgets/QLabel>
 #include <QtCore/QRandomGenerator64>
+#include <QtCore/QThread>
+#include <QtWidgets/QLabel>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
 #include "MathOperationDataModel.hpp"
 #include "DecimalData.hpp"
 
 /// The model generates a random value in a long processing schema,
-/// as it should demonstrate the usage of the NodeProcessingStatus.
+/// as it should demonstrate the usage of the asynchronous compute API and
+/// the NodeProcessingStatus it maintains.
 /// The random number is generate in the [n1, n2] interval.
 class RandomNumberModel : public MathOperationDataModel
 {
 public:
-    RandomNumberModel()
-        : _timer(new QTimer(this))
-    {
-        this->setNodeProcessingStatus(QtNodes::NodeProcessingStatus::Empty);
+    RandomNumberModel() { this->setNodeProcessingStatus(QtNodes::NodeProcessingStatus::Empty); }
 
-        QObject::connect(this, &NodeDelegateModel::computingStarted, this, [this]() {
-            if (_number1.lock() && _number2.lock()) {
-                this->setNodeProcessingStatus(QtNodes::NodeProcessingStatus::Processing);
-            }
-            emit requestNodeUpdate();
-        });
-        QObject::connect(this, &NodeDelegateModel::computingFinished, this, [this]() {
-            this->setNodeProcessingStatus(QtNodes::NodeProcessingStatus::Updated);
-            emit requestNodeUpdate();
-        });
-    }
     virtual ~RandomNumberModel() {}
 
 public:
@@ -41,47 +32,43 @@ public:
 private:
     void compute() override
     {
-        // Stop any previous computation
-        _timer->stop();
-        _timer->disconnect();
-
-        Q_EMIT computingStarted();
         PortIndex const outPortIndex = 0;
 
         auto n1 = _number1.lock();
         auto n2 = _number2.lock();
 
-        _secondsRemaining = 3;
-        _timer->start(1000);
-        connect(_timer, &QTimer::timeout, this, [this, n1, n2, outPortIndex]() {
-            if (--_secondsRemaining <= 0) {
-                _timer->stop();
-                if (n1 && n2) {
-                    double a = n1->number();
-                    double b = n2->number();
+        if (!n1 || !n2) {
+            _result.reset();
+            setNodeProcessingStatus(QtNodes::NodeProcessingStatus::Empty);
+            Q_EMIT requestNodeUpdate();
+            Q_EMIT dataUpdated(outPortIndex);
+            return;
+        }
 
-                    if (a > b) {
-                        setNodeProcessingStatus(QtNodes::NodeProcessingStatus::Failed);
-                        emit requestNodeUpdate();
-                        return;
-                    }
+        double const a = n1->number();
+        double const b = n2->number();
 
-                    double upper = std::nextafter(b, std::numeric_limits<double>::max());
-                    double randomValue = QRandomGenerator::global()->generateDouble() * (upper - a)
-                                         + a;
-
-                    _result = std::make_shared<DecimalData>(randomValue);
-                    Q_EMIT computingFinished();
-                } else {
-                    _result.reset();
+        // A new input supersedes the previous run; only the latest result is
+        // published.
+        startCompute(
+            [a, b](QtNodes::ComputeTask const &task) {
+                // Imitates three seconds of work that can be abandoned halfway.
+                for (int i = 0; i < 30 && !task.isCancelled(); ++i) {
+                    QThread::msleep(100);
                 }
 
+                // Reported as NodeProcessingStatus::Failed.
+                if (a > b)
+                    throw std::invalid_argument("Lower bound exceeds upper bound");
+
+                double upper = std::nextafter(b, std::numeric_limits<double>::max());
+                double randomValue = QRandomGenerator::global()->generateDouble() * (upper - a) + a;
+
+                return std::make_shared<DecimalData>(randomValue);
+            },
+            [this, outPortIndex](std::shared_ptr<DecimalData> const &result) {
+                _result = result;
                 Q_EMIT dataUpdated(outPortIndex);
-            }
-        });
+            });
     }
-
-private:
-    QTimer *_timer;
-    int _secondsRemaining = 0;
 };
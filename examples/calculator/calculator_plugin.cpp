@@ -0,0 +1,27 @@
+#include "AdditionModel.hpp"
+#include "DivisionModel.hpp"
+#include "LongProcessingRandomNumber.hpp"
+#include "MultiplicationModel.hpp"
+#include "NumberDisplayDataModel.hpp"
+#include "NumberSourceDataModel.hpp"
+#include "SubtractionModel.hpp"
+
+#include <QtNodes/NodeRegistryPlugin>
+
+/// Makes the calculator models available to `flow_runner --plugin`.
+QT_NODES_REGISTRY_PLUGIN(registry)
+{
+    registry.registerModel<NumberSourceDataModel>("Sources");
+
+    registry.registerModel<NumberDisplayDataModel>("Displays");
+
+    registry.registerModel<AdditionModel>("Operators");
+
+    registry.registerModel<SubtractionModel>("Operators");
+
+    registry.registerModel<MultiplicationModel>("Operators");
+
+    registry.registerModel<DivisionModel>("Operators");
+
+    registry.registerModel<RandomNumberModel>("Operators");
+}
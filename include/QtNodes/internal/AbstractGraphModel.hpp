@@ -1,17 +1,50 @@
 #pragma once
 
 #include "ConnectionIdHash.hpp"
+#include "DataTypeRegistry.hpp"
 #include "Definitions.hpp"
 #include "Export.hpp"
 
+#include <QtCore/QByteArray>
 #include <QtCore/QJsonObject>
 #include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <QtCore/QSize>
 #include <QtCore/QVariant>
 
 #include <unordered_set>
 
+class QWidget;
+
 namespace QtNodes {
 
+class NodeStyle;
+
+/**
+ * Net structural changes accumulated during a batch, see
+ * AbstractGraphModel::beginBatch().
+ *
+ * Items created and deleted inside the same batch are not reported. A node
+ * deleted and then re-created with the same id appears in both sets.
+ */
+struct GraphChangeDelta
+{
+    std::unordered_set<NodeId> createdNodes;
+    std::unordered_set<NodeId> deletedNodes;
+
+    /// Nodes that emitted `nodeUpdated` and were not created in the batch.
+    std::unordered_set<NodeId> updatedNodes;
+
+    std::unordered_set<ConnectionId> createdConnections;
+    std::unordered_set<ConnectionId> deletedConnections;
+
+    bool empty() const
+    {
+        return createdNodes.empty() && deletedNodes.empty() && updatedNodes.empty()
+               && createdConnections.empty() && deletedConnections.empty();
+    }
+};
+
 /**
  * The central class in the Model-View approach. It delivers all kinds
  * of information from the backing user data structures that represent
@@ -26,6 +59,8 @@ class NODE_EDITOR_PUBLIC AbstractGraphModel : public QObject
 {
     Q_OBJECT
 public:
+    AbstractGraphModel();
+
     /// Generates a new unique NodeId.
     virtual NodeId newNodeId() = 0;
 
@@ -115,6 +150,54 @@ public:
         return NodeFlag::NoFlags;
     }
 
+    /**
+     * Direct access to the style of the node, which skips the JSON round trip
+     * of `nodeData(nodeId, NodeRole::Style)` on the painting path.
+     *
+     * The default implementation returns `nullptr` and the painters fall back
+     * to NodeRole::Style, caching the result until `nodeUpdated(nodeId)`.
+     * Overrides must return a style that stays valid while the node exists.
+     */
+    virtual NodeStyle const *nodeStyle(NodeId const nodeId) const
+    {
+        Q_UNUSED(nodeId);
+        return nullptr;
+    }
+
+    /**
+     * @name Typed queries
+     *
+     * Shortcuts for the values the geometry and painters read many times per
+     * frame. The default implementations unwrap `nodeData` and `portData`;
+     * models that can answer directly should override them to skip the
+     * QVariant round trip.
+     */
+    ///@{
+    /// NodeRole::InPortCount or NodeRole::OutPortCount.
+    virtual unsigned int portCount(NodeId nodeId, PortType portType) const;
+
+    /// NodeRole::Size.
+    virtual QSize nodeSize(NodeId nodeId) const;
+
+    /// NodeRole::Caption.
+    virtual QString nodeCaption(NodeId nodeId) const;
+
+    /// NodeRole::CaptionVisible.
+    virtual bool nodeCaptionVisible(NodeId nodeId) const;
+
+    /// NodeRole::Widget.
+    virtual QWidget *nodeWidget(NodeId nodeId) const;
+
+    /// PortRole::Caption.
+    virtual QString portCaption(NodeId nodeId, PortType portType, PortIndex index) const;
+
+    /// PortRole::CaptionVisible.
+    virtual bool portCaptionVisible(NodeId nodeId, PortType portType, PortIndex index) const;
+
+    /// PortRole::DataType.
+    virtual NodeDataType portDataType(NodeId nodeId, PortType portType, PortIndex index) const;
+    ///@}
+
     /**
      * @brief Sets node properties.
      *
@@ -135,6 +218,16 @@ public:
                               PortIndex index,
                               PortRole role) const = 0;
 
+    /**
+     * Interned `NodeDataType::id` of the port, used for type checks and
+     * colors without comparing strings.
+     *
+     * The default implementation unwraps `portData(..., PortRole::DataType)`.
+     */
+    virtual DataTypeHandle portDataTypeHandle(NodeId nodeId,
+                                              PortType portType,
+                                              PortIndex index) const;
+
     /**
      * A utility function that unwraps the `QVariant` value returned from the
      * standard `QVariant AbstractGraphModel::portData(...)` function.
@@ -186,6 +279,20 @@ public:
      */
     virtual void loadNode(QJsonObject const &) {}
 
+    /**
+     * Compact copy of the node's internal data kept by the undo commands.
+     * The id and the position are stored next to it and must not be part of
+     * the blob. The default returns an empty array, in which case the
+     * commands fall back to `saveNode()` and `loadNode()`.
+     */
+    virtual QByteArray saveNodeState(NodeId const) const { return {}; }
+
+    /**
+     * Recreates the node `nodeId` at `position` from a `saveNodeState()`
+     * blob. Must do the same as `loadNode()` does for the JSON.
+     */
+    virtual void restoreNodeState(NodeId const, QPointF const &, QByteArray const &) {}
+
     virtual bool loopsEnabled() const { return true; }
 
 public:
@@ -229,6 +336,23 @@ public:
      */
     void portsInserted();
 
+public:
+    /**
+     * Opens a bulk mutation. Until the matching `endBatch()` the model
+     * keeps emitting its per-item signals, but also records their net effect.
+     * Batches can be nested, only the outermost one is reported.
+     *
+     * Listeners that can process a whole delta at once (BasicGraphicsScene)
+     * skip the per-item work while `batchInProgress()` is `true` and apply
+     * `graphChanged()` instead.
+     */
+    void beginBatch();
+
+    /// Closes the batch and emits `graphChanged()` unless nothing changed.
+    void endBatch();
+
+    bool batchInProgress() const { return _batchDepth > 0; }
+
 Q_SIGNALS:
     void connectionCreated(ConnectionId const connectionId);
 
@@ -246,8 +370,36 @@ Q_SIGNALS:
 
     void modelReset();
 
+    /// Emitted once by the outermost `endBatch()`.
+    void graphChanged(QtNodes::GraphChangeDelta const &delta);
+
 private:
     std::vector<ConnectionId> _shiftedByDynamicPortsConnections;
+
+    unsigned int _batchDepth = 0;
+
+    GraphChangeDelta _batchDelta;
+};
+
+/// Scoped `beginBatch()`/`endBatch()` pair.
+class GraphChangeBatch
+{
+public:
+    explicit GraphChangeBatch(AbstractGraphModel &model)
+        : _model(model)
+    {
+        _model.beginBatch();
+    }
+
+    ~GraphChangeBatch() { _model.endBatch(); }
+
+    GraphChangeBatch(GraphChangeBatch const &) = delete;
+    GraphChangeBatch &operator=(GraphChangeBatch const &) = delete;
+
+private:
+    AbstractGraphModel &_model;
 };
 
 } // namespace QtNodes
+
+Q_DECLARE_METATYPE(QtNodes::GraphChangeDelta)
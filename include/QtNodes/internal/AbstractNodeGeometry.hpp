@@ -69,6 +69,15 @@ public:
 
     virtual QRect resizeHandleRect(NodeId const nodeId) const = 0;
 
+    /**
+     * Drops whatever the geometry caches about the node. The scene calls it
+     * when the node is updated or deleted.
+     */
+    virtual void invalidate(NodeId const nodeId) { Q_UNUSED(nodeId); }
+
+    /// Drops all cached data, for example after the application font changed.
+    virtual void invalidateAll() {}
+
 protected:
     AbstractGraphModel &_graphModel;
 };
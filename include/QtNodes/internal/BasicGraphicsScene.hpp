@@ -7,8 +7,11 @@
 #include "Export.hpp"
 
 #include "QUuidStdHash.hpp"
+#include "RenderDiagnostics.hpp"
+#include "SceneSpatialIndex.hpp"
 
 #include <QtCore/QUuid>
+#include <QtGui/QTransform>
 #include <QtWidgets/QGraphicsScene>
 #include <QtWidgets/QMenu>
 
@@ -16,6 +19,9 @@
 #include <memory>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 class QUndoStack;
 
@@ -27,6 +33,7 @@ class AbstractNodePainter;
 class ConnectionGraphicsObject;
 class NodeGraphicsObject;
 class NodeStyle;
+class UndoHistory;
 
 /// An instance of QGraphicsScene, holds connections and nodes.
 class NODE_EDITOR_PUBLIC BasicGraphicsScene : public QGraphicsScene
@@ -62,6 +69,9 @@ public:
 
     QUndoStack &undoStack();
 
+    /// Memory accounting and limit for `undoStack()`.
+    UndoHistory &undoHistory();
+
 public:
     /**
      * @brief Creates a "draft" instance of ConnectionGraphicsObject.
@@ -87,6 +97,49 @@ public:
     /// Deletes all the nodes. Connections are removed automatically.
     void clearScene();
 
+    /**
+     * Stops building graphics objects for nodes and connections created in
+     * the model. Calls can be nested. Useful for bulk insertions such as
+     * loading a large file.
+     */
+    void suspendUpdates();
+
+    /**
+     * Ends a `suspendUpdates()` section. The outermost call creates the
+     * graphics objects of all nodes and connections added meanwhile in one
+     * pass and emits `modified()` once.
+     */
+    void resumeUpdates();
+
+    bool updatesSuspended() const { return _suspendDepth > 0; }
+
+    /**
+     * Starts moving the selected nodes as one gesture. The selection and the
+     * connections attached to it are collected once here.
+     */
+    void beginNodeDrag();
+
+    /**
+     * Shifts the nodes of the current gesture by `diff`. Only the graphics
+     * objects move; the model keeps the positions from `beginNodeDrag()`.
+     */
+    void dragNodes(QPointF const &diff);
+
+    /**
+     * Writes the final positions to the model through a single
+     * MoveNodeCommand on the undo stack.
+     */
+    void endNodeDrag();
+
+    /**
+     * Abandons the current gesture without touching the undo stack. The
+     * graphics objects return to the positions the model still holds.
+     * Deleting a dragged node or resetting the model cancels the gesture.
+     */
+    void cancelNodeDrag();
+
+    bool nodeDragInProgress() const { return _dragInProgress; }
+
 public:
     /**
      * @returns NodeGraphicsObject associated with the given nodeId.
@@ -100,10 +153,44 @@ public:
      */
     ConnectionGraphicsObject *connectionGraphicsObject(ConnectionId connectionId);
 
+    /**
+     * Scene bounding rectangles of the node and connection graphics objects,
+     * kept up to date as they are created, moved, resized and removed.
+     * Backs hit-testing since the scene itself runs without an item index.
+     */
+    SceneSpatialIndex const &spatialIndex() const { return _spatialIndex; }
+
+    SceneSpatialIndex &spatialIndex() { return _spatialIndex; }
+
     Qt::Orientation orientation() const { return _orientation; }
 
     void setOrientation(Qt::Orientation const orientation);
 
+    /**
+     * Scales, as given by QStyleOptionGraphicsItem::levelOfDetailFromTransform(),
+     * below which painting switches to LevelOfDetail::Simplified and
+     * LevelOfDetail::Outline. The defaults are 0.6 and 0.4.
+     */
+    void setLevelOfDetailThresholds(double const simplified, double const outline);
+
+    /// Tier the painters use under the given painter world transform.
+    LevelOfDetail levelOfDetail(QTransform const &worldTransform) const;
+
+    /**
+     * Shows the embedded node widgets while at least one view of the scene
+     * is at LevelOfDetail::Full and hides them otherwise. Visibility is a
+     * property of the scene, so it is decided across all views; GraphicsView
+     * calls this whenever its scale changes.
+     */
+    void updateNodeWidgetVisibility();
+
+    bool nodeWidgetsVisible() const { return _nodeWidgetsVisible; }
+
+    /// Per-frame paint counters, recorded while enabled.
+    RenderDiagnostics const &renderDiagnostics() const { return _renderDiagnostics; }
+
+    RenderDiagnostics &renderDiagnostics() { return _renderDiagnostics; }
+
 public:
     /**
      * Can @return an instance of the scene context menu in subclass.
@@ -111,6 +198,10 @@ public:
      */
     virtual QMenu *createSceneMenu(QPointF const scenePos);
 
+protected:
+    /// Re-measures all nodes after the application font changed.
+    bool event(QEvent *event) override;
+
 Q_SIGNALS:
     void modified(BasicGraphicsScene *);
     void nodeMoved(NodeId const nodeId, QPointF const &newLocation);
@@ -155,6 +246,9 @@ public Q_SLOTS:
     virtual void onNodeClicked(NodeId const nodeId);
     virtual void onModelReset();
 
+    /// Applies a whole AbstractGraphModel batch in one pass.
+    virtual void onGraphChanged(GraphChangeDelta const &delta);
+
 private:
     AbstractGraphModel &_graphModel;
 
@@ -164,12 +258,28 @@ private:
     std::unordered_map<NodeId, UniqueNodeGraphicsObject> _nodeGraphicsObjects;
     std::unordered_map<ConnectionId, UniqueConnectionGraphicsObject> _connectionGraphicsObjects;
     std::unique_ptr<ConnectionGraphicsObject> _draftConnection;
+    SceneSpatialIndex _spatialIndex;
+    RenderDiagnostics _renderDiagnostics;
     std::unique_ptr<AbstractNodeGeometry> _nodeGeometry;
     std::unique_ptr<AbstractNodePainter> _nodePainter;
     std::unique_ptr<AbstractConnectionPainter> _connectionPainter;
     bool _nodeDrag;
     QUndoStack *_undoStack;
+    UndoHistory *_undoHistory;
     Qt::Orientation _orientation;
+    double _simplifiedDetailThreshold = 0.6;
+    double _outlineDetailThreshold = 0.4;
+    bool _nodeWidgetsVisible = true;
+
+    bool _dragInProgress = false;
+    QPointF _dragOffset;
+    std::vector<std::pair<NodeId, QPointF>> _draggedNodes;
+    std::vector<ConnectionId> _draggedConnections;
+
+    unsigned int _suspendDepth = 0;
+    bool _modifiedWhileSuspended = false;
+    std::unordered_set<NodeId> _deferredNodes;
+    std::unordered_set<ConnectionId> _deferredConnections;
 };
 
 } // namespace QtNodes
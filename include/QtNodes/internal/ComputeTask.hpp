@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Export.hpp"
+
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+namespace QtNodes {
+
+/**
+ * Handle of an asynchronous computation started with
+ * `NodeDelegateModel::startCompute()`.
+ *
+ * The handle is cheap to copy; all copies refer to the same computation.
+ * The work function receives it to poll `isCancelled()` and stop early.
+ */
+class NODE_EDITOR_PUBLIC ComputeTask
+{
+public:
+    ComputeTask() = default;
+
+    /// `false` for a default-constructed handle.
+    bool isValid() const { return _state != nullptr; }
+
+    /// Requests the computation to stop. Its result will not be published.
+    void cancel();
+
+    bool isCancelled() const;
+
+    /// `true` once the work function has returned or the task was skipped.
+    bool isFinished() const;
+
+    /// Blocks until the work function has returned.
+    void waitForFinished() const;
+
+    /// Increases with every computation started by the same node.
+    quint64 generation() const;
+
+    bool operator==(ComputeTask const &other) const { return _state == other._state; }
+
+    bool operator!=(ComputeTask const &other) const { return _state != other._state; }
+
+private:
+    friend class NodeDelegateModel;
+    friend class ComputeRunnable;
+
+    struct State
+    {
+        quint64 generation = 0;
+
+        std::atomic<bool> cancelled{false};
+
+        /// Set once the work function is about to be called.
+        bool started = false;
+
+        bool finished = false;
+
+        mutable QMutex mutex;
+
+        mutable QWaitCondition finishedCondition;
+    };
+
+    explicit ComputeTask(std::shared_ptr<State> state)
+        : _state(std::move(state))
+    {}
+
+    /**
+     * Claims the task for its runnable. A task cancelled before it started is
+     * marked finished instead and `false` is returned.
+     */
+    bool markStarted();
+
+    bool hasStarted() const;
+
+    void markFinished();
+
+private:
+    std::shared_ptr<State> _state;
+};
+
+} // namespace QtNodes
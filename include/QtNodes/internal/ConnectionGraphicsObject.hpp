@@ -3,6 +3,7 @@
 #include <utility>
 
 #include <QtCore/QUuid>
+#include <QtGui/QPainterPath>
 #include <QtWidgets/QGraphicsObject>
 
 #include "ConnectionState.hpp"
@@ -49,11 +50,18 @@ public:
 
     std::pair<QPointF, QPointF> pointsC1C2() const;
 
+    /// Cubic spline from `out()` to `in()`, rebuilt only after an end point moves.
+    QPainterPath const &cubicPath() const;
+
     void setEndPoint(PortType portType, QPointF const &point);
 
     /// Updates the position of both ends
     void move();
 
+    /// Drops the cached path, shape and bounding rect, e.g. after the
+    /// connection painter was replaced.
+    void invalidateGeometry();
+
     ConnectionState const &connectionState() const;
 
     ConnectionState &connectionState();
@@ -82,6 +90,10 @@ private:
 
     std::pair<QPointF, QPointF> pointsC1C2Vertical() const;
 
+    /// Rebuilds the cached path and bounding rect if the end points or the
+    /// scene orientation changed since the last call.
+    void updateGeometry() const;
+
 private:
     ConnectionId _connectionId;
 
@@ -91,6 +103,16 @@ private:
 
     mutable QPointF _out;
     mutable QPointF _in;
+
+    // Geometry cache, see updateGeometry().
+    mutable bool _geometryValid = false;
+    mutable Qt::Orientation _cachedOrientation = Qt::Horizontal;
+    mutable QPainterPath _cubicPath;
+    mutable QRectF _boundingRect;
+
+    /// Built lazily, only hit tests need it.
+    mutable QPainterPath _shape;
+    mutable bool _shapeValid = false;
 };
 
 } // namespace QtNodes
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <QtCore/QHash>
+#include <QtCore/QString>
 #include <QtGui/QColor>
 
+#include "DataTypeRegistry.hpp"
 #include "Export.hpp"
 #include "Style.hpp"
 
+#include <vector>
+
 namespace QtNodes {
 
 class NODE_EDITOR_PUBLIC ConnectionStyle : public Style
@@ -27,7 +32,15 @@ public:
 public:
     QColor constructionColor() const;
     QColor normalColor() const;
+    /**
+     * Color of connections carrying `typeId` when `useDataDefinedColors()` is
+     * on. Unless overridden by `setTypeColor()` or the "DataTypeColors" JSON
+     * object, the color is derived from the id once and memoized.
+     */
     QColor normalColor(QString typeId) const;
+
+    /// Same as above for an interned type id, looked up by index.
+    QColor normalColor(DataTypeHandle const typeHandle) const;
     QColor selectedColor() const;
     QColor selectedHaloColor() const;
     QColor hoveredColor() const;
@@ -38,6 +51,18 @@ public:
 
     bool useDataDefinedColors() const;
 
+public:
+    /// Pre-registers or overrides the color used for connections of `typeId`.
+    void setTypeColor(QString const &typeId, QColor const &color);
+
+    /// Drops the override, `typeId` gets its derived color again.
+    void resetTypeColor(QString const &typeId);
+
+    QHash<QString, QColor> const &typeColors() const { return _typeColorOverrides; }
+
+private:
+    static QColor generatedTypeColor(QString const &typeId);
+
 private:
     QColor ConstructionColor;
     QColor NormalColor;
@@ -50,5 +75,13 @@ private:
     float PointDiameter;
 
     bool UseDataDefinedColors;
+
+    QHash<QString, QColor> _typeColorOverrides;
+
+    /// Colors derived on demand, painting happens in the GUI thread only.
+    mutable QHash<QString, QColor> _typeColorCache;
+
+    /// Resolved colors indexed by DataTypeHandle, invalid until first use.
+    mutable std::vector<QColor> _handleColorCache;
 };
 } // namespace QtNodes
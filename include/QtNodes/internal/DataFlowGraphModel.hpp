@@ -2,15 +2,30 @@
 
 #include "AbstractGraphModel.hpp"
 #include "ConnectionIdUtils.hpp"
+#include "ExecutionPlan.hpp"
 #include "NodeDelegateModelRegistry.hpp"
+#include "NodeProfiler.hpp"
 #include "Serializable.hpp"
 #include "StyleCollection.hpp"
+#include "TopologicalOrder.hpp"
 
 #include "Export.hpp"
 
 #include <QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class QIODevice;
 
 namespace QtNodes {
 
@@ -27,6 +42,11 @@ public:
         QPointF pos;
     };
 
+    enum class ExecutionMode {
+        Sequential, ///< All nodes are evaluated on the model thread.
+        Parallel,   ///< Independent thread-safe nodes are evaluated on a thread pool.
+    };
+
 public:
     DataFlowGraphModel(std::shared_ptr<NodeDelegateModelRegistry> registry);
 
@@ -55,6 +75,9 @@ public:
 
     NodeFlags nodeFlags(NodeId nodeId) const override;
 
+    /// Style owned by the node's NodeDelegateModel.
+    NodeStyle const *nodeStyle(NodeId const nodeId) const override;
+
     bool setNodeData(NodeId nodeId, NodeRole role, QVariant value) override;
 
     QVariant portData(NodeId nodeId,
@@ -62,6 +85,29 @@ public:
                       PortIndex portIndex,
                       PortRole role) const override;
 
+    /// The delegate's cached `NodeDelegateModel::dataTypeHandle()`.
+    DataTypeHandle portDataTypeHandle(NodeId nodeId,
+                                      PortType portType,
+                                      PortIndex portIndex) const override;
+
+    // Typed queries answered by the delegates directly.
+
+    unsigned int portCount(NodeId nodeId, PortType portType) const override;
+
+    QSize nodeSize(NodeId nodeId) const override;
+
+    QString nodeCaption(NodeId nodeId) const override;
+
+    bool nodeCaptionVisible(NodeId nodeId) const override;
+
+    QWidget *nodeWidget(NodeId nodeId) const override;
+
+    QString portCaption(NodeId nodeId, PortType portType, PortIndex portIndex) const override;
+
+    bool portCaptionVisible(NodeId nodeId, PortType portType, PortIndex portIndex) const override;
+
+    NodeDataType portDataType(NodeId nodeId, PortType portType, PortIndex portIndex) const override;
+
     bool setPortData(NodeId nodeId,
                      PortType portType,
                      PortIndex portIndex,
@@ -76,12 +122,54 @@ public:
 
     void loadNode(QJsonObject const &nodeJson) override;
 
+    /// The delegate's `save()` object as a CBOR blob.
+    QByteArray saveNodeState(NodeId const nodeId) const override;
+
+    /// Throws `std::logic_error` for a blob that cannot be decoded.
+    void restoreNodeState(NodeId const nodeId,
+                          QPointF const &position,
+                          QByteArray const &state) override;
+
     // From Serializable
     QJsonObject save() const override;
 
     // From Serializable
     void load(QJsonObject const &json) override;
 
+    /**
+     * Writes the graph in a compact binary format: a versioned header, a node
+     * table, a table of packed `ConnectionId`s and the nodes' "internal-data"
+     * objects as CBOR blobs. Returns `false` if writing failed.
+     */
+    bool saveBinary(QIODevice &device) const;
+
+    /**
+     * Restores a graph written by `saveBinary()` into the model. Returns
+     * `false` if the data is not in the binary format, was written by a newer
+     * version or is truncated; the model is left unchanged in that case.
+     * Throws std::logic_error for unregistered node models, like `load()`.
+     */
+    bool loadBinary(QIODevice &device);
+
+    /// Checks the format signature without consuming data from the device.
+    static bool isBinaryFormat(QIODevice &device);
+
+    /// Receives the number of restored nodes and connections and their total.
+    using LoadProgressCallback = std::function<void(std::size_t, std::size_t)>;
+
+    /**
+     * Restores a graph stored either in JSON or in the binary format while
+     * reporting progress after every `chunkSize` restored items.
+     *
+     * Binary data is consumed node by node and never held in memory as a
+     * whole. The callback may process events to keep the UI responsive; it
+     * must not modify the model. Returns `false` on malformed data, which
+     * can leave the model partially loaded.
+     */
+    bool loadIncrementally(QIODevice &device,
+                           LoadProgressCallback const &progress = {},
+                           std::size_t const chunkSize = 1000);
+
     /**
      * Fetches the NodeDelegateModel for the given `nodeId` and tries to cast the
      * stored pointer to the given type
@@ -101,19 +189,138 @@ public:
     /// Loops do not make any sense in uni-direction data propagation
     bool loopsEnabled() const override { return false; }
 
+    /**
+     * Starts a propagation transaction. Calls can be nested.
+     *
+     * While a transaction is open, data reported by nodes through
+     * `NodeDelegateModel::dataUpdated` and data delivered by new or removed
+     * connections is only collected. The outermost `endUpdate()` then
+     * evaluates every affected node once, in topological order, so a node
+     * with several changed inputs pushes its result downstream only once.
+     *
+     * Outside of a transaction every change is flushed immediately, using the
+     * same ordering.
+     */
+    void beginUpdate();
+
+    /// Closes a transaction opened by `beginUpdate()` and flushes it if it
+    /// was the outermost one.
+    void endUpdate();
+
+    /// Tells whether a transaction is open or being flushed.
+    bool updateInProgress() const { return _updateDepth > 0; }
+
+    /**
+     * In the `Parallel` mode the affected part of the graph is evaluated in
+     * waves of nodes that do not depend on each other. Within a wave, nodes
+     * whose `NodeDelegateModel::threadSafeCompute()` returns `true` receive
+     * their inputs on the thread pool while the remaining ones are evaluated
+     * on the model thread. The results are pushed downstream from the model
+     * thread once the whole wave has finished.
+     *
+     * The model thread waits for every wave, so a slow thread-safe node still
+     * blocks it for its own duration; work that must not block belongs in
+     * `NodeDelegateModel::startCompute()`. Thread-safe nodes must not call
+     * `startCompute()` themselves, since it emits signals and changes the
+     * node's status from the worker thread.
+     */
+    void setExecutionMode(ExecutionMode mode) { _executionMode = mode; }
+
+    ExecutionMode executionMode() const { return _executionMode; }
+
+    /**
+     * Pool for the `Parallel` mode. `nullptr` selects a pool owned by the
+     * model, separate from the global pool used by `startCompute()`.
+     */
+    void setThreadPool(QThreadPool *pool) { _threadPool = pool; }
+
+    QThreadPool *threadPool() const;
+
+    /**
+     * Per-node timings of the propagation. Nothing is recorded until
+     * `profiler().setEnabled(true)` is called.
+     */
+    NodeProfiler &profiler() { return _profiler; }
+
+    NodeProfiler const &profiler() const { return _profiler; }
+
+    /// The profiler's Chrome trace with events named after the node captions.
+    QJsonObject profileTrace() const;
+
+    /**
+     * Increases whenever a node, a connection or a port is added or removed.
+     * Data changes do not affect it.
+     */
+    quint64 structureVersion() const { return _structureVersion; }
+
+    /**
+     * Freezes the current topology into an ExecutionPlan for repeated
+     * evaluation. The plan is invalid if the graph contains a cycle and
+     * becomes invalid with the next change of `structureVersion()`.
+     */
+    ExecutionPlan compile();
+
 Q_SIGNALS:
     void inPortDataWasSet(NodeId const, PortType const, PortIndex const);
 
 private:
+    friend class ExecutionPlan;
+
     NodeId newNodeId() override { return _nextNodeId++; }
 
+    /// Creates the delegate for `internalDataJson` under the given id and restores it.
+    void restoreNode(NodeId const nodeId, QPointF const &pos, QJsonObject const &internalDataJson);
+
     void sendConnectionCreation(ConnectionId const connectionId);
 
     void sendConnectionDeletion(ConnectionId const connectionId);
 
+    /// Registers the connection in the per-port and per-node adjacency indices.
+    void indexConnection(ConnectionId const connectionId);
+
+    /// Removes the connection from the adjacency indices.
+    void unindexConnection(ConnectionId const connectionId);
+
+    struct PendingUpdate
+    {
+        /// Input values to deliver, the latest value per port wins.
+        std::map<PortIndex, QVariant> inPorts;
+
+        /// Output ports whose data has to be pushed downstream.
+        std::set<PortIndex> outPorts;
+
+        /// Producer of the latest delivered input, reported to the profiler.
+        NodeId cause = InvalidNodeId;
+    };
+
+    PendingUpdate &pendingUpdate(NodeId const nodeId);
+
+    void scheduleInPortData(NodeId const nodeId, PortIndex const portIndex, QVariant const &data);
+
+    /// Evaluates pending updates until none is left.
+    void flushUpdates();
+
+    /// Evaluates pending nodes one by one in topological order.
+    void flushInOrder();
+
+    /// Re-queues the pending nodes under their current ranks.
+    void rebuildUpdateQueue();
+
+    /// Evaluates the pending part of the graph wave by wave.
+    void flushInWaves();
+
+    void evaluateWave(std::vector<NodeId> const &wave);
+
+    /// Delivers the pending inputs to the node on the model thread.
+    void deliverInPortData(NodeId const nodeId, PendingUpdate const &update);
+
+    /// Pushes the given outputs of the node to the inputs of its consumers.
+    void pushOutPortData(NodeId const nodeId, std::set<PortIndex> outPorts);
+
 private Q_SLOTS:
     /**
-     * Fuction is called in three cases:
+     * Schedules the port's data to be pushed downstream. The function is
+     * called in three cases:
      *
      * - By underlying NodeDelegateModel when a node has new data to propagate.
      *   @see DataFlowGraphModel::addNode
@@ -136,6 +343,48 @@ private:
 
     std::unordered_set<ConnectionId> _connectivity;
 
+    using PortKey = std::tuple<NodeId, PortType, PortIndex>;
+
+    /// Adjacency index mirroring `_connectivity`. Makes port queries O(degree).
+    std::unordered_map<PortKey, std::unordered_set<ConnectionId>> _portConnections;
+
+    /// Adjacency index mirroring `_connectivity`. Makes node queries O(degree).
+    std::unordered_map<NodeId, std::unordered_set<ConnectionId>> _nodeConnections;
+
+    /// Node order used to answer loop checks in `connectionPossible` incrementally.
+    TopologicalOrder _topology;
+
+    unsigned int _updateDepth = 0;
+
+    std::unordered_map<NodeId, PendingUpdate> _pendingUpdates;
+
+    using QueueEntry = std::pair<TopologicalOrder::Rank, NodeId>;
+
+    /// Nodes with pending updates, lowest rank first.
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> _updateQueue;
+
+    /// Set when ranks may have changed since the nodes were queued.
+    bool _updateQueueStale = false;
+
+    ExecutionMode _executionMode = ExecutionMode::Sequential;
+
+    QThreadPool *_threadPool = nullptr;
+
+    /// Created on first use when no pool is set.
+    mutable std::unique_ptr<QThreadPool> _ownThreadPool;
+
+    /// Outputs reported by nodes running on worker threads.
+    std::vector<std::pair<NodeId, PortIndex>> _concurrentOutPorts;
+
+    QMutex _concurrentOutPortsMutex;
+
+    NodeProfiler _profiler;
+
+    quint64 _structureVersion = 0;
+
+    /// Number of ExecutionPlan runs in progress.
+    unsigned int _planDepth = 0;
+
     mutable std::unordered_map<NodeId, NodeGeometryData> _nodeGeometryData;
 };
 
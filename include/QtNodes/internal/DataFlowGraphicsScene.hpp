@@ -4,6 +4,8 @@
 #include "DataFlowGraphModel.hpp"
 #include "Export.hpp"
 
+#include <cstddef>
+
 namespace QtNodes {
 
 /**
@@ -30,6 +32,9 @@ public Q_SLOTS:
 Q_SIGNALS:
     void sceneLoaded();
 
+    /// Reports restored nodes and connections while `load()` reads a file.
+    void loadProgress(std::size_t done, std::size_t total);
+
 private:
     DataFlowGraphModel &_graphModel;
 };
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Export.hpp"
+#include "NodeData.hpp"
+
+#include <QtCore/QString>
+
+#include <cstddef>
+
+namespace QtNodes {
+
+/// Small integer standing for a `NodeDataType::id`, see DataTypeRegistry.
+using DataTypeHandle = unsigned int;
+
+/// Handle of the empty type id.
+static constexpr DataTypeHandle InvalidDataTypeHandle = 0;
+
+/**
+ * Process-wide table interning data type ids into `DataTypeHandle`s.
+ *
+ * Two ids are equal exactly when their handles are equal, so type checks on
+ * the connection and painting paths become integer compares. Handles are
+ * never released and stay valid for the lifetime of the process.
+ *
+ * All functions are thread-safe.
+ */
+class NODE_EDITOR_PUBLIC DataTypeRegistry
+{
+public:
+    /// Returns the handle of `typeId`, registering it on first use.
+    static DataTypeHandle intern(QString const &typeId);
+
+    static DataTypeHandle intern(NodeDataType const &dataType) { return intern(dataType.id); }
+
+    /// The id `handle` stands for, empty for unknown handles.
+    static QString typeId(DataTypeHandle const handle);
+
+    /// Number of registered ids.
+    static std::size_t size();
+
+private:
+    DataTypeRegistry() = delete;
+};
+
+} // namespace QtNodes
@@ -4,6 +4,9 @@
 
 #include <QtGui/QFontMetrics>
 
+#include <unordered_map>
+#include <vector>
+
 namespace QtNodes {
 
 class AbstractGraphModel;
@@ -36,6 +39,10 @@ public:
 
     QRect resizeHandleRect(NodeId const nodeId) const override;
 
+    void invalidate(NodeId const nodeId) override;
+
+    void invalidateAll() override;
+
 private:
     QRectF portTextRect(NodeId const nodeId,
                         PortType const portType,
@@ -55,6 +62,21 @@ private:
     unsigned int _portSpasing;
     mutable QFontMetrics _fontMetrics;
     mutable QFontMetrics _boldFontMetrics;
+
+    /// Text measurements of a node, indexed by PortType::In / PortType::Out.
+    struct NodeCache
+    {
+        QRectF captionRect;
+
+        std::vector<QRectF> portTextRects[2];
+
+        unsigned int maxPortsTextAdvance[2];
+    };
+
+    /// Measures the node on first use or after its port counts changed.
+    NodeCache const &nodeCache(NodeId const nodeId) const;
+
+    mutable std::unordered_map<NodeId, NodeCache> _nodeCache;
 };
 
 } // namespace QtNodes
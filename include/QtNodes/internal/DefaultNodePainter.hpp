@@ -22,6 +22,9 @@ public:
 
     void drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const;
 
+    /// Flat rectangle used for LevelOfDetail::Outline.
+    void drawNodeOutline(QPainter *painter, NodeGraphicsObject &ngo) const;
+
     void drawConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const;
 
     void drawFilledConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const;
@@ -36,7 +39,17 @@ public:
 
     void drawValidationIcon(QPainter *painter, NodeGraphicsObject &ngo) const;
 
+    /// Heat bar and accumulated compute time taken from DataFlowGraphModel::profiler().
+    void drawProfilerOverlay(QPainter *painter, NodeGraphicsObject &ngo) const;
+
+    /// Shows the profiler overlay on nodes of a profiled DataFlowGraphModel. Off by default.
+    void setProfilerOverlayEnabled(bool const enabled) { _profilerOverlay = enabled; }
+
+    bool profilerOverlayEnabled() const { return _profilerOverlay; }
+
 private:
     QIcon _toolTipIcon{":/info-tooltip.svg"};
+
+    bool _profilerOverlay = false;
 };
 } // namespace QtNodes
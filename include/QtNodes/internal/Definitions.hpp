@@ -82,6 +82,17 @@ enum class PortType {
 };
 Q_ENUM_NS(PortType)
 
+/**
+ * Rendering tiers picked by the painters from the current zoom, see
+ * BasicGraphicsScene::levelOfDetail().
+ */
+enum class LevelOfDetail {
+    Full = 0,       ///< Everything is drawn.
+    Simplified = 1, ///< Only node bodies with captions and connection curves.
+    Outline = 2,    ///< Flat node rectangles and straight connection lines.
+};
+Q_ENUM_NS(LevelOfDetail)
+
 using PortCount = unsigned int;
 
 /// ports are consecutively numbered starting from zero.
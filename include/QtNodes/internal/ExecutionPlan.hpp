@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include "Export.hpp"
+#include "NodeData.hpp"
+
+#include <QtCore/QPointer>
+#include <QtCore/QtGlobal>
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+class DataFlowGraphModel;
+class NodeDelegateModel;
+
+/**
+ * A DataFlowGraphModel frozen by `DataFlowGraphModel::compile()` for repeated
+ * evaluation of the same topology.
+ *
+ * The nodes are stored as a flat array of steps in topological order. Every
+ * output port owns a data slot, and every input refers to the slot of its
+ * producer by index, so a run hands `std::shared_ptr<NodeData>` from node to
+ * node directly: no QVariant boxing, no connection lookups and no propagation
+ * scheduling.
+ *
+ * The plan is bound to the model's `structureVersion()`. Adding or removing a
+ * node, a connection or a port invalidates it and `run()` refuses to execute.
+ */
+class NODE_EDITOR_PUBLIC ExecutionPlan
+{
+public:
+    /// An invalid plan.
+    ExecutionPlan() = default;
+
+    /// `false` once the model's structure changed or the model was destroyed.
+    bool isValid() const;
+
+    std::size_t stepCount() const { return _steps.size(); }
+
+    /**
+     * Pins an output of the node: runs use `data` instead of asking the node's
+     * `outData()`. Ignored for unknown nodes and ports.
+     */
+    void setSourceData(NodeId const nodeId,
+                       PortIndex const portIndex,
+                       std::shared_ptr<NodeData> data);
+
+    /// Releases all pinned outputs.
+    void clearSourceData();
+
+    /**
+     * Evaluates every node once, in order: the inputs are delivered through
+     * `NodeDelegateModel::setInData()`, then the outputs are read into their
+     * slots. Nodes without connected inputs only have their outputs read.
+     *
+     * Data reported through `NodeDelegateModel::dataUpdated` during the run is
+     * not propagated by the model and the scene is not notified.
+     *
+     * A node that answers its inputs with `NodeDelegateModel::startCompute()`
+     * has no result to read yet. The run stops there and returns `false`, and
+     * `pendingNodeId()` names the node; the outputs of that node and of the
+     * steps after it keep the values of the previous run. The result arrives
+     * later through the normal propagation of the model.
+     *
+     * Returns `false` without doing anything if the plan is invalid.
+     */
+    bool run();
+
+    /// Node whose asynchronous computation stopped the latest run, `InvalidNodeId` if none.
+    NodeId pendingNodeId() const { return _pendingNodeId; }
+
+    /// Output of the node as of the latest run, `nullptr` for unknown ports.
+    std::shared_ptr<NodeData> outData(NodeId const nodeId, PortIndex const portIndex) const;
+
+private:
+    friend class DataFlowGraphModel;
+
+    struct Input
+    {
+        PortIndex portIndex;
+
+        /// Index into `_slots`.
+        std::size_t slot;
+    };
+
+    struct Step
+    {
+        NodeId nodeId;
+
+        NodeDelegateModel *model;
+
+        /// Range in `_inputs`.
+        std::size_t firstInput;
+        std::size_t inputCount;
+
+        /// Range in `_slots`, one slot per output port.
+        std::size_t firstSlot;
+        std::size_t slotCount;
+    };
+
+    /// Slot of the output port, or `_slots.size()` if there is none.
+    std::size_t slotIndex(NodeId const nodeId, PortIndex const portIndex) const;
+
+private:
+    QPointer<DataFlowGraphModel> _model;
+
+    quint64 _structureVersion = 0;
+
+    std::vector<Step> _steps;
+
+    std::vector<Input> _inputs;
+
+    std::vector<std::shared_ptr<NodeData>> _slots;
+
+    /// Slots set by `setSourceData()`, not overwritten by runs.
+    std::vector<char> _pinned;
+
+    std::unordered_map<NodeId, std::size_t> _stepIndex;
+
+    NodeId _pendingNodeId = InvalidNodeId;
+};
+
+} // namespace QtNodes
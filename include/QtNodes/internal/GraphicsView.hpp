@@ -4,6 +4,8 @@
 
 #include "Export.hpp"
 
+class QRubberBand;
+
 namespace QtNodes {
 
 class BasicGraphicsScene;
@@ -43,6 +45,14 @@ public:
 
     double getScale() const;
 
+    /**
+     * Draws the scene's RenderDiagnostics of the latest frame in the top left
+     * corner of the viewport. Enabling the overlay enables the recording.
+     */
+    void setRenderDiagnosticsOverlayEnabled(bool const enabled);
+
+    bool renderDiagnosticsOverlayEnabled() const { return _diagnosticsOverlay; }
+
 public Q_SLOTS:
     void scaleUp();
 
@@ -78,8 +88,15 @@ protected:
 
     void mouseMoveEvent(QMouseEvent *event) override;
 
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
     void drawBackground(QPainter *painter, const QRectF &r) override;
 
+    void drawForeground(QPainter *painter, const QRectF &r) override;
+
+    /// Delimits the frames of the scene's RenderDiagnostics.
+    void paintEvent(QPaintEvent *event) override;
+
     void showEvent(QShowEvent *event) override;
 
 protected:
@@ -88,6 +105,10 @@ protected:
     /// Computes scene position for pasting the copied/duplicated node groups.
     QPointF scenePastePosition();
 
+private:
+    /// Selects the items under the rubber band, found through the scene's spatial index.
+    void updateRubberBandSelection();
+
 private:
     QAction *_clearSelectionAction = nullptr;
     QAction *_deleteSelectionAction = nullptr;
@@ -97,5 +118,17 @@ private:
 
     QPointF _clickPos;
     ScaleRange _scaleRange;
+
+    /// Shift is held: left drags on the background select instead of panning.
+    bool _rubberBandSelection = false;
+
+    QRubberBand *_rubberBand = nullptr;
+
+    QPoint _rubberBandOrigin;
+
+    bool _diagnosticsOverlay = false;
+
+    /// Viewport area of the overlay drawn last.
+    QRect _diagnosticsOverlayRect;
 };
 } // namespace QtNodes
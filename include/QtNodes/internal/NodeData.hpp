@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
+#include <QtCore/QJsonValue>
 #include <QtCore/QObject>
 #include <QtCore/QString>
 
@@ -36,6 +38,12 @@ public:
 
     /// Type for inner use
     virtual NodeDataType type() const = 0;
+
+    /// Approximate size of the payload, reported to NodeProfiler. `0` if unknown.
+    virtual std::size_t byteSize() const { return 0; }
+
+    /// Payload for tools that print results, e.g. `flow_runner`. Null if not provided.
+    virtual QJsonValue toJson() const { return QJsonValue(); }
 };
 
 } // namespace QtNodes
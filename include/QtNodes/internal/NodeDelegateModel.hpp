@@ -1,12 +1,16 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include <QMetaType>
 #include <QPixmap>
 #include <QtGui/QColor>
 #include <QtWidgets/QWidget>
 
+#include "ComputeTask.hpp"
+#include "DataTypeRegistry.hpp"
 #include "Definitions.hpp"
 #include "Export.hpp"
 #include "NodeData.hpp"
@@ -47,6 +51,8 @@ enum class NodeProcessingStatus : int {
 };
 
 class StyleCollection;
+class ComputeRunnable;
+struct ComputeTiming;
 
 /**
  * The class wraps Node-specific data operations and propagates it to
@@ -63,7 +69,8 @@ class NODE_EDITOR_PUBLIC NodeDelegateModel
 public:
     NodeDelegateModel();
 
-    virtual ~NodeDelegateModel() = default;
+    /// Cancels outstanding computations and waits for their work functions.
+    virtual ~NodeDelegateModel();
 
     /// It is possible to hide caption in GUI
     virtual bool captionVisible() const { return true; }
@@ -98,6 +105,16 @@ public:
 
     virtual NodeDataType dataType(PortType portType, PortIndex portIndex) const = 0;
 
+    /**
+     * `dataType()` interned by DataTypeRegistry, cached per port. The cache
+     * is dropped when the node emits `portsInserted()` or `portsDeleted()`;
+     * a node changing the type of an existing port calls
+     * `invalidateDataTypeHandles()`. Model thread only.
+     */
+    DataTypeHandle dataTypeHandle(PortType const portType, PortIndex const portIndex) const;
+
+    void invalidateDataTypeHandles();
+
     virtual ConnectionPolicy portConnectionPolicy(PortType, PortIndex) const;
 
     NodeStyle const &nodeStyle() const;
@@ -132,6 +149,74 @@ public:
 
     virtual bool resizable() const { return false; }
 
+    /**
+     * Capability flag for the parallel execution mode of DataFlowGraphModel.
+     *
+     * Return `true` if `setInData()` may be called from a worker thread. The
+     * implementation must then not touch the embedded widget and must not
+     * access state shared with other nodes. `outData()` is still called on
+     * the model thread, after `setInData()` has returned.
+     *
+     * Such a `setInData()` must not call `startCompute()`, which has to run
+     * on the thread of this object.
+     */
+    virtual bool threadSafeCompute() const { return false; }
+
+    /// Handle of the latest computation started with `startCompute()`.
+    ComputeTask currentCompute() const { return _currentCompute; }
+
+    /**
+     * Cancels the latest computation; its result is dropped and the status
+     * becomes `Pending`. DataFlowGraphModel calls this when new input data
+     * did not start a computation that supersedes the running one.
+     */
+    void cancelCompute();
+
+protected:
+    /**
+     * Runs `work` on `QThreadPool::globalInstance()` and hands its result to
+     * `publish` on the thread of this object.
+     *
+     * Starting a computation cancels the previous one, so only results of the
+     * latest generation are published. The processing status is maintained
+     * automatically: `Pending` while queued, `Processing` while running, then
+     * `Updated`, or `Failed` if `work` throws. `computingStarted()` is
+     * emitted when the node becomes busy, `computingFinished()` when the
+     * latest run has finished or was cancelled, so the two always pair up.
+     *
+     * `work` is called as `work(ComputeTask const &)` and may poll
+     * `ComputeTask::isCancelled()`. It must not access this object; capture
+     * the inputs by value. `publish` receives the returned value and usually
+     * stores it and emits `dataUpdated()`.
+     *
+     * Must be called from the thread of this object, typically in `setInData()`.
+     */
+    template<typename Work, typename Publish>
+    ComputeTask startCompute(Work work, Publish publish)
+    {
+        return startComputeImpl(
+            [work = std::move(work), publish = std::move(publish)](
+                ComputeTask const &task) -> std::function<void()> {
+                auto result = work(task);
+
+                return [publish, result]() { publish(result); };
+            });
+    }
+
+private:
+    ComputeTask startComputeImpl(std::function<std::function<void()>(ComputeTask const &)> work);
+
+    void onComputeStarted(ComputeTask const &task);
+
+    void onComputeFinished(ComputeTask const &task,
+                           std::function<void()> const &publish,
+                           bool failed,
+                           ComputeTiming const &timing);
+
+    bool isCurrentCompute(ComputeTask const &task) const;
+
+    friend class ComputeRunnable;
+
 public Q_SLOTS:
     virtual void inputConnectionCreated(ConnectionId const &) {}
     virtual void inputConnectionDeleted(ConnectionId const &) {}
@@ -149,6 +234,15 @@ Q_SIGNALS:
 
     void computingFinished();
 
+    /**
+     * Reports the wall time of the work function of a `startCompute()` run,
+     * also of a superseded one, once it has returned. `startNs` is taken on
+     * the worker `thread` with `NodeProfiler::steadyClockNs()`. Emitted on
+     * the thread of this object; DataFlowGraphModel hands it to its
+     * NodeProfiler.
+     */
+    void computeTimed(qint64 startNs, qint64 durationNs, quint64 generation, Qt::HANDLE thread);
+
     void embeddedWidgetSizeUpdated();
 
     /// Request an update of the node's UI.
@@ -188,6 +282,18 @@ private:
     NodeValidationState _nodeValidationState;
 
     NodeProcessingStatus _processingStatus{NodeProcessingStatus::NoStatus};
+
+    ComputeTask _currentCompute;
+
+    quint64 _computeGeneration{0};
+
+    /// Tasks whose work function may still be running.
+    std::vector<ComputeTask> _outstandingComputes;
+
+    /// Interned port types, filled on first use.
+    mutable std::vector<DataTypeHandle> _inDataTypeHandles;
+
+    mutable std::vector<DataTypeHandle> _outDataTypeHandles;
 };
 
 } // namespace QtNodes
@@ -6,6 +6,9 @@
 
 #include "Export.hpp"
 #include "NodeState.hpp"
+#include "NodeStyle.hpp"
+
+#include <memory>
 
 class QGraphicsProxyWidget;
 
@@ -54,6 +57,19 @@ public:
 
     void updateQWidgetEmbedPos();
 
+    /// Shows or hides the embedded widget, if there is one.
+    void setWidgetVisible(bool const visible);
+
+    /**
+     * Style used for painting. Taken from AbstractGraphModel::nodeStyle()
+     * when the model provides it, otherwise parsed from NodeRole::Style once
+     * and kept until `invalidateNodeStyle()`.
+     */
+    NodeStyle const &nodeStyle() const;
+
+    /// Called by the scene when the model reports `nodeUpdated`.
+    void invalidateNodeStyle();
+
 protected:
     void paint(QPainter *painter,
                QStyleOptionGraphicsItem const *option,
@@ -64,6 +80,7 @@ protected:
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
     void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
+    void mouseUngrabEvent(QEvent *event) override;
     void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
     void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
     void hoverMoveEvent(QGraphicsSceneHoverEvent *) override;
@@ -83,5 +100,7 @@ private:
 
     // either nullptr or owned by parent QGraphicsItem
     QGraphicsProxyWidget *_proxyWidget;
+
+    mutable std::unique_ptr<NodeStyle> _cachedNodeStyle;
 };
 } // namespace QtNodes
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include "Export.hpp"
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QtGlobal>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * Records how DataFlowGraphModel spends its time while propagating data.
+ *
+ * Every evaluation of a node, i.e. the delivery of its pending inputs
+ * through `NodeDelegateModel::setInData()`, is one invocation. Work a node
+ * runs with `NodeDelegateModel::startCompute()` is added to the same node's
+ * time when it returns, without counting another invocation. The profiler
+ * accumulates per-node wall time and invocation counts, the bytes of
+ * NodeData the node pushed downstream as reported by `NodeData::byteSize()`,
+ * and keeps a bounded log of events with the node whose output caused each
+ * evaluation.
+ *
+ * Recording is thread-safe, nodes evaluated on the thread pool in the
+ * `Parallel` execution mode report from their worker threads.
+ */
+class NODE_EDITOR_PUBLIC NodeProfiler
+{
+public:
+    struct NodeStats
+    {
+        std::size_t invocations = 0;
+
+        qint64 totalNs = 0;
+
+        qint64 maxNs = 0;
+
+        std::size_t bytesProduced = 0;
+
+        /// Producer that triggered the latest invocation, `InvalidNodeId` if none.
+        NodeId lastCause = InvalidNodeId;
+    };
+
+    struct Event
+    {
+        NodeId nodeId;
+
+        /// Node whose output was delivered, `InvalidNodeId` for structural changes.
+        NodeId causeId;
+
+        /// Start on the trace clock, which runs from the profiler's creation.
+        qint64 startNs;
+
+        qint64 durationNs;
+
+        /// Thread the node was evaluated on, numbered in order of appearance.
+        int thread;
+
+        /// Whether the event times a `startCompute()` run instead of `setInData()`.
+        bool compute = false;
+
+        /// `ComputeTask::generation()` of the run for compute events.
+        quint64 generation = 0;
+    };
+
+public:
+    NodeProfiler();
+
+    /// Recording is off by default.
+    void setEnabled(bool const enabled);
+
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    /// Forgets all statistics and events.
+    void clear();
+
+    /// Oldest events are dropped beyond this count; statistics are kept.
+    void setMaxEvents(std::size_t const count);
+
+    std::size_t maxEvents() const { return _maxEvents; }
+
+public:
+    NodeStats stats(NodeId const nodeId) const;
+
+    std::unordered_map<NodeId, NodeStats> allStats() const;
+
+    /// Largest `NodeStats::totalNs` of all nodes, useful to scale heat maps.
+    qint64 maxTotalNs() const;
+
+    std::vector<Event> events() const;
+
+    /**
+     * Follows the latest causes upstream: `nodeId`, the producer that
+     * triggered its latest invocation, that producer's own cause, and so on.
+     */
+    std::vector<NodeId> causeChain(NodeId const nodeId) const;
+
+    /**
+     * The recorded events in the Chrome trace event format, readable by
+     * chrome://tracing and Perfetto. Events are named by `nodeName`, or by
+     * their node id when no function is given.
+     */
+    QJsonObject chromeTrace(std::function<QString(NodeId)> const &nodeName = {}) const;
+
+public:
+    /// Current time on the trace clock.
+    qint64 now() const { return fromSteadyClock(steadyClockNs()); }
+
+    /**
+     * Current time of `std::chrono::steady_clock` in nanoseconds. Threads
+     * without access to the profiler take their timestamps with it.
+     */
+    static qint64 steadyClockNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /// Converts a `steadyClockNs()` timestamp to the trace clock.
+    qint64 fromSteadyClock(qint64 const steadyNs) const { return steadyNs - _originNs; }
+
+    void recordInvocation(NodeId const nodeId,
+                          NodeId const causeId,
+                          qint64 const startNs,
+                          qint64 const durationNs);
+
+    /// Adds the run of a `startCompute()` work function to `nodeId`.
+    void recordCompute(NodeId const nodeId,
+                       qint64 const startNs,
+                       qint64 const durationNs,
+                       quint64 const generation,
+                       Qt::HANDLE const thread);
+
+    void recordBytes(NodeId const nodeId, std::size_t const bytes);
+
+    void removeNode(NodeId const nodeId);
+
+private:
+    int threadIndex();
+
+    int threadIndex(Qt::HANDLE const thread);
+
+private:
+    std::atomic<bool> _enabled{false};
+
+    /// `steadyClockNs()` at the creation of the profiler.
+    qint64 _originNs;
+
+    std::size_t _maxEvents = 100000;
+
+    mutable QMutex _mutex;
+
+    std::unordered_map<NodeId, NodeStats> _stats;
+
+    qint64 _maxTotalNs = 0;
+
+    std::deque<Event> _events;
+
+    std::unordered_map<quintptr, int> _threads;
+};
+
+} // namespace QtNodes
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Export.hpp"
+#include "NodeDelegateModelRegistry.hpp"
+
+/**
+ * Defines the entry point of a shared library that contributes node models
+ * to a NodeDelegateModelRegistry, e.g. for the `flow_runner` tool:
+ *
+ * @code
+ * QT_NODES_REGISTRY_PLUGIN(registry)
+ * {
+ *     registry.registerModel<AdditionModel>("Operators");
+ * }
+ * @endcode
+ */
+#define QT_NODES_REGISTRY_PLUGIN(registry) \
+    NODE_EDITOR_DEMANGLED NODE_EDITOR_EXPORT void qtNodesRegisterModels( \
+        QtNodes::NodeDelegateModelRegistry &registry)
+
+namespace QtNodes {
+
+/// Symbol defined by `QT_NODES_REGISTRY_PLUGIN`.
+static constexpr char const *RegistryPluginEntryPoint = "qtNodesRegisterModels";
+
+using RegistryPluginFunction = void (*)(NodeDelegateModelRegistry &);
+
+} // namespace QtNodes
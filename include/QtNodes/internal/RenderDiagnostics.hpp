@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Export.hpp"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtGlobal>
+#include <QtGui/QRegion>
+
+#include <cstddef>
+
+namespace QtNodes {
+
+/**
+ * Paint counters of a BasicGraphicsScene, grouped into frames.
+ *
+ * A frame is one paint event of a GraphicsView showing the scene. Node and
+ * connection graphics objects report every call into their painters, and the
+ * view closes the frame with the number of cached nodes its update region
+ * exposed. As the nodes use QGraphicsItem::DeviceCoordinateCache, their
+ * `paint()` only runs when the cache is regenerated; every other exposed
+ * cached node is counted as a cache hit.
+ *
+ * Recording is off by default and meant for the GUI thread only.
+ */
+class NODE_EDITOR_PUBLIC RenderDiagnostics
+{
+public:
+    struct Frame
+    {
+        std::size_t nodePaints = 0;
+
+        std::size_t connectionPaints = 0;
+
+        /// Time spent in AbstractNodePainter::paint().
+        qint64 nodePaintNs = 0;
+
+        /// Time spent in AbstractConnectionPainter::paint().
+        qint64 connectionPaintNs = 0;
+
+        std::size_t cacheHits = 0;
+
+        std::size_t cacheMisses = 0;
+
+        /// Viewport update region, empty for accumulated totals.
+        QRegion updateRegion;
+
+        /// Area of the update region in device-independent pixels.
+        qint64 updatePixels = 0;
+
+        /// Duration of the whole paint event.
+        qint64 frameNs = 0;
+    };
+
+public:
+    RenderDiagnostics();
+
+    void setEnabled(bool const enabled) { _enabled = enabled; }
+
+    bool isEnabled() const { return _enabled; }
+
+    /// Forgets all frames.
+    void reset();
+
+    /// The latest completed frame.
+    Frame const &lastFrame() const { return _lastFrame; }
+
+    /// Sum of all frames since the last `reset()`.
+    Frame const &totals() const { return _totals; }
+
+    std::size_t frameCount() const { return _frameCount; }
+
+public:
+    qint64 now() const { return _clock.nsecsElapsed(); }
+
+    void beginFrame(QRegion const &updateRegion);
+
+    /// `exposedCachedNodes` is the number of cached nodes within the update region.
+    void endFrame(std::size_t const exposedCachedNodes);
+
+    void recordNodePaint(qint64 const durationNs, bool const cached);
+
+    void recordConnectionPaint(qint64 const durationNs);
+
+private:
+    bool _enabled = false;
+
+    QElapsedTimer _clock;
+
+    qint64 _frameStart = 0;
+
+    Frame _current;
+
+    Frame _lastFrame;
+
+    Frame _totals;
+
+    std::size_t _frameCount = 0;
+};
+
+} // namespace QtNodes
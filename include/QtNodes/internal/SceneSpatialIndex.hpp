@@ -0,0 +1,121 @@
+#pragma once
+
+#include "ConnectionIdHash.hpp"
+#include "Definitions.hpp"
+#include "Export.hpp"
+
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtCore/QtGlobal>
+
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * Uniform grid over the scene bounding rectangles of node and connection
+ * graphics objects.
+ *
+ * BasicGraphicsScene runs with QGraphicsScene::NoIndex because nodes move
+ * all the time and a BSP tree would be rebuilt on every drag step. The grid
+ * makes a move O(1) as long as the item stays within the same cells, and
+ * lets point and area queries visit only the items around the query.
+ *
+ * Items covering too many cells (long connections) are kept in a separate
+ * list that every query scans.
+ *
+ * `locateNodeAt()`, node hover handling and the rubber-band selection of
+ * GraphicsView go through the grid. QGraphicsScene's own hover dispatch,
+ * mouse-press item lookup and the collection of exposed items when painting
+ * cannot be redirected and remain linear in the number of items.
+ */
+class NODE_EDITOR_PUBLIC SceneSpatialIndex
+{
+public:
+    explicit SceneSpatialIndex(qreal const cellSize = 256.0);
+
+    qreal cellSize() const { return _cellSize; }
+
+public:
+    /// Inserts the node or moves it to the new `sceneRect`.
+    void updateNode(NodeId const nodeId, QRectF const &sceneRect);
+
+    void removeNode(NodeId const nodeId);
+
+    /// Inserts the connection or moves it to the new `sceneRect`.
+    void updateConnection(ConnectionId const &connectionId, QRectF const &sceneRect);
+
+    void removeConnection(ConnectionId const &connectionId);
+
+    void clear();
+
+    std::size_t nodeCount() const { return _nodes.entries.size(); }
+
+    std::size_t connectionCount() const { return _connections.entries.size(); }
+
+public:
+    /// Nodes whose bounding rectangle contains `scenePoint`, in no particular order.
+    std::vector<NodeId> nodesAt(QPointF const &scenePoint) const;
+
+    /// Nodes whose bounding rectangle intersects `sceneRect`.
+    std::vector<NodeId> nodesIn(QRectF const &sceneRect) const;
+
+    /// Connections whose bounding rectangle intersects `sceneRect`.
+    std::vector<ConnectionId> connectionsIn(QRectF const &sceneRect) const;
+
+private:
+    struct CellRange
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+
+        std::size_t cellCount() const;
+
+        bool operator==(CellRange const &other) const;
+    };
+
+    template<typename Id>
+    struct Grid
+    {
+        struct Entry
+        {
+            QRectF rect;
+            CellRange cells;
+            bool oversized;
+        };
+
+        std::unordered_map<Id, Entry> entries;
+
+        std::unordered_map<quint64, std::vector<Id>> cells;
+
+        std::unordered_set<Id> oversized;
+    };
+
+    CellRange cellRange(QRectF const &rect) const;
+
+    template<typename Id>
+    void update(Grid<Id> &grid, Id const &id, QRectF const &rect);
+
+    template<typename Id>
+    void remove(Grid<Id> &grid, Id const &id);
+
+    template<typename Id>
+    void unlink(Grid<Id> &grid, Id const &id, typename Grid<Id>::Entry const &entry);
+
+    template<typename Id, typename Predicate>
+    std::vector<Id> query(Grid<Id> const &grid, QRectF const &area, Predicate accept) const;
+
+private:
+    qreal _cellSize;
+
+    Grid<NodeId> _nodes;
+
+    Grid<ConnectionId> _connections;
+};
+
+} // namespace QtNodes
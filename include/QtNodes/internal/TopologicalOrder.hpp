@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include "Export.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * Keeps a topological order of a directed node graph up to date while edges
+ * are inserted and removed (Pearce-Kelly dynamic topological sort).
+ *
+ * Every node has a rank, and for each edge `from -> to` the rank of `from` is
+ * smaller than the rank of `to`. An edge that agrees with the current order is
+ * answered and inserted in O(1); otherwise only the nodes ranked between the
+ * two endpoints are visited and reordered.
+ *
+ * Parallel edges between the same pair of nodes are counted, so every
+ * connection is added and removed individually. When a cycle is forced in
+ * (AbstractGraphModel::addConnection does not re-check connectionPossible)
+ * the order becomes invalid and queries fall back to plain graph searches
+ * until the cycle is broken again.
+ */
+class NODE_EDITOR_PUBLIC TopologicalOrder
+{
+public:
+    using Rank = std::int64_t;
+
+public:
+    void addNode(NodeId const nodeId);
+
+    /// Removes the node together with all its incoming and outgoing edges.
+    void removeNode(NodeId const nodeId);
+
+    bool hasNode(NodeId const nodeId) const;
+
+    void addEdge(NodeId const from, NodeId const to);
+
+    void removeEdge(NodeId const from, NodeId const to);
+
+    /// Tells whether adding the edge `from -> to` would close a cycle.
+    bool wouldCreateCycle(NodeId const from, NodeId const to) const;
+
+    /// `false` while the graph contains a cycle.
+    bool isValid() const { return _valid; }
+
+    /**
+     * Sorting key of the node. Ranks are unique but not contiguous.
+     * Meaningful only while the order `isValid()`.
+     */
+    Rank rank(NodeId const nodeId) const;
+
+    /// All nodes sorted by rank.
+    std::vector<NodeId> sortedNodes() const;
+
+    void clear();
+
+private:
+    struct Node
+    {
+        Rank rank;
+
+        /// Adjacent node -> number of parallel edges.
+        std::unordered_map<NodeId, unsigned int> successors;
+
+        std::unordered_map<NodeId, unsigned int> predecessors;
+    };
+
+    /// Restores the order after inserting `from -> to` with rank(from) > rank(to).
+    /// Returns `false` if the edge closes a cycle.
+    bool reorder(NodeId const from, NodeId const to);
+
+    /// Forward search from `start` through nodes ranked at most `upperBound`.
+    bool reaches(NodeId const start, NodeId const target, Rank const upperBound) const;
+
+    /// Recomputes all ranks from scratch (Kahn's algorithm).
+    void rebuild();
+
+private:
+    std::unordered_map<NodeId, Node> _nodes;
+
+    Rank _nextRank = 0;
+
+    bool _valid = true;
+};
+
+} // namespace QtNodes
@@ -3,17 +3,63 @@
 #include "Definitions.hpp"
 #include "Export.hpp"
 
+#include <QtCore/QByteArray>
 #include <QtCore/QJsonObject>
 #include <QtCore/QPointF>
 #include <QUndoCommand>
 
+#include <cstddef>
 #include <unordered_set>
+#include <vector>
 
 namespace QtNodes {
 
 class BasicGraphicsScene;
 
-class NODE_EDITOR_PUBLIC CreateCommand : public QUndoCommand
+/**
+ * Nodes and connections removed or re-inserted by an undo command.
+ *
+ * Ids, positions and connections are stored as plain values. The node's
+ * internal data is the opaque AbstractGraphModel::saveNodeState() blob, or
+ * the saveNode() JSON for models that do not provide one.
+ */
+struct NODE_EDITOR_PUBLIC GraphFragment
+{
+    struct Node
+    {
+        NodeId id;
+        QPointF position;
+        QByteArray state;
+
+        /// Used when `state` is empty.
+        QJsonObject json;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<ConnectionId> connections;
+
+    bool empty() const { return nodes.empty() && connections.empty(); }
+
+    /// Approximate heap memory held by the fragment.
+    std::size_t byteSize() const;
+};
+
+/**
+ * Undo command that reports its memory footprint to UndoHistory.
+ */
+class NODE_EDITOR_PUBLIC SizedUndoCommand : public QUndoCommand
+{
+public:
+    using QUndoCommand::QUndoCommand;
+
+    /// Approximate memory held by the command, in bytes.
+    virtual std::size_t byteSize() const = 0;
+
+    /// Drops the stored state of a command that will never be undone again.
+    virtual void releaseState() {}
+};
+
+class NODE_EDITOR_PUBLIC CreateCommand : public SizedUndoCommand
 {
 public:
     CreateCommand(BasicGraphicsScene *scene, QString const name, QPointF const &mouseScenePos);
@@ -21,17 +67,21 @@ public:
     void undo() override;
     void redo() override;
 
+    std::size_t byteSize() const override;
+    void releaseState() override;
+
 private:
     BasicGraphicsScene *_scene;
     NodeId _nodeId;
-    QJsonObject _sceneJson;
+    GraphFragment _fragment;
+    std::size_t _fragmentSize = 0;
 };
 
 /**
  * Selected scene objects are serialized and then removed from the scene.
  * The deleted elements could be restored in `undo`.
  */
-class NODE_EDITOR_PUBLIC DeleteCommand : public QUndoCommand
+class NODE_EDITOR_PUBLIC DeleteCommand : public SizedUndoCommand
 {
 public:
     DeleteCommand(BasicGraphicsScene *scene);
@@ -39,9 +89,13 @@ public:
     void undo() override;
     void redo() override;
 
+    std::size_t byteSize() const override;
+    void releaseState() override;
+
 private:
     BasicGraphicsScene *_scene;
-    QJsonObject _sceneJson;
+    GraphFragment _fragment;
+    std::size_t _fragmentSize = 0;
 };
 
 class NODE_EDITOR_PUBLIC CopyCommand : public QUndoCommand
@@ -50,7 +104,7 @@ public:
     CopyCommand(BasicGraphicsScene *scene);
 };
 
-class NODE_EDITOR_PUBLIC PasteCommand : public QUndoCommand
+class NODE_EDITOR_PUBLIC PasteCommand : public SizedUndoCommand
 {
 public:
     PasteCommand(BasicGraphicsScene *scene, QPointF const &mouseScenePos);
@@ -58,17 +112,21 @@ public:
     void undo() override;
     void redo() override;
 
+    std::size_t byteSize() const override;
+    void releaseState() override;
+
 private:
     QJsonObject takeSceneJsonFromClipboard();
-    QJsonObject makeNewNodeIdsInScene(QJsonObject const &sceneJson);
+    void makeNewNodeIdsInScene(GraphFragment &fragment);
 
 private:
     BasicGraphicsScene *_scene;
     QPointF const &_mouseScenePos;
-    QJsonObject _newSceneJson;
+    GraphFragment _newFragment;
+    std::size_t _fragmentSize = 0;
 };
 
-class NODE_EDITOR_PUBLIC DisconnectCommand : public QUndoCommand
+class NODE_EDITOR_PUBLIC DisconnectCommand : public SizedUndoCommand
 {
 public:
     DisconnectCommand(BasicGraphicsScene *scene, ConnectionId const);
@@ -76,13 +134,15 @@ public:
     void undo() override;
     void redo() override;
 
+    std::size_t byteSize() const override;
+
 private:
     BasicGraphicsScene *_scene;
 
     ConnectionId _connId;
 };
 
-class NODE_EDITOR_PUBLIC ConnectCommand : public QUndoCommand
+class NODE_EDITOR_PUBLIC ConnectCommand : public SizedUndoCommand
 {
 public:
     ConnectCommand(BasicGraphicsScene *scene, ConnectionId const);
@@ -90,17 +150,27 @@ public:
     void undo() override;
     void redo() override;
 
+    std::size_t byteSize() const override;
+
 private:
     BasicGraphicsScene *_scene;
 
     ConnectionId _connId;
 };
 
-class NODE_EDITOR_PUBLIC MoveNodeCommand : public QUndoCommand
+class NODE_EDITOR_PUBLIC MoveNodeCommand : public SizedUndoCommand
 {
 public:
     MoveNodeCommand(BasicGraphicsScene *scene, QPointF const &diff);
 
+    /**
+     * Moves `nodeIds` by `diff` as one finished gesture, see
+     * BasicGraphicsScene::beginNodeDrag(). Such commands are not merged.
+     */
+    MoveNodeCommand(BasicGraphicsScene *scene,
+                    std::unordered_set<NodeId> nodeIds,
+                    QPointF const &diff);
+
     void undo() override;
     void redo() override;
 
@@ -115,10 +185,13 @@ public:
    */
     bool mergeWith(QUndoCommand const *c) override;
 
+    std::size_t byteSize() const override;
+
 private:
     BasicGraphicsScene *_scene;
     std::unordered_set<NodeId> _selectedNodes;
     QPointF _diff;
+    bool _mergeable;
 };
 
 } // namespace QtNodes
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Export.hpp"
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+#include <cstddef>
+
+class QAction;
+class QUndoCommand;
+class QUndoStack;
+
+namespace QtNodes {
+
+/**
+ * Keeps the memory held by a QUndoStack within a budget.
+ *
+ * Every command is weighed by SizedUndoCommand::byteSize(); other commands
+ * count with a fixed estimate. When the commands that can still be undone
+ * exceed the limit, the oldest ones are evicted: their state is released and
+ * they are marked obsolete, so QUndoStack drops them instead of undoing them.
+ * The most recent command is always kept.
+ *
+ * Evicted commands stay at the bottom of the stack, below `undoBoundary()`.
+ * `QUndoStack::canUndo()` does not know about them, so undo through `undo()`
+ * or `createUndoAction()`, which stop at the boundary.
+ */
+class NODE_EDITOR_PUBLIC UndoHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UndoHistory(QUndoStack &undoStack, QObject *parent = nullptr);
+
+    /// Budget in bytes, `0` (the default) disables eviction.
+    void setMemoryLimit(std::size_t const bytes);
+
+    std::size_t memoryLimit() const { return _memoryLimit; }
+
+    /// Approximate memory held by the commands still on the stack.
+    std::size_t memoryUsage() const { return _memoryUsage; }
+
+    /// Number of commands evicted so far.
+    std::size_t evictedCount() const { return _evictedCount; }
+
+    /// Index below which the commands on the stack have been evicted.
+    int undoBoundary() const { return _undoBoundary; }
+
+    /// Whether the command below the stack index can still be undone.
+    bool canUndo() const;
+
+    /**
+     * Like `QUndoStack::createUndoAction()`, but the action is disabled once
+     * the stack index reaches `undoBoundary()`.
+     */
+    QAction *createUndoAction(QObject *parent, QString const &prefix = QString());
+
+public Q_SLOTS:
+    /// Undoes the last command unless it has been evicted.
+    void undo();
+
+    /// Approximate memory held by `command` and its children.
+    static std::size_t commandSize(QUndoCommand const *command);
+
+Q_SIGNALS:
+    void memoryUsageChanged(std::size_t bytes);
+
+    void canUndoChanged(bool canUndo);
+
+private:
+    void update();
+
+    static void releaseState(QUndoCommand *command);
+
+private:
+    QUndoStack &_undoStack;
+
+    std::size_t _memoryLimit = 0;
+
+    std::size_t _memoryUsage = 0;
+
+    std::size_t _evictedCount = 0;
+
+    int _undoBoundary = 0;
+
+    bool _canUndo = false;
+};
+
+} // namespace QtNodes
@@ -2,8 +2,127 @@
 
 #include <QtNodes/ConnectionIdUtils>
 
+#include <QtWidgets/QWidget>
+
+#include <utility>
+
 namespace QtNodes {
 
+AbstractGraphModel::AbstractGraphModel()
+{
+    // Derived models emit the signals themselves, a batch observes them.
+    connect(this, &AbstractGraphModel::nodeCreated, this, [this](NodeId const nodeId) {
+        if (batchInProgress())
+            _batchDelta.createdNodes.insert(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::nodeDeleted, this, [this](NodeId const nodeId) {
+        if (!batchInProgress())
+            return;
+
+        _batchDelta.updatedNodes.erase(nodeId);
+
+        if (_batchDelta.createdNodes.erase(nodeId) == 0)
+            _batchDelta.deletedNodes.insert(nodeId);
+    });
+
+    connect(this, &AbstractGraphModel::nodeUpdated, this, [this](NodeId const nodeId) {
+        if (batchInProgress() && _batchDelta.createdNodes.count(nodeId) == 0)
+            _batchDelta.updatedNodes.insert(nodeId);
+    });
+
+    connect(this,
+            &AbstractGraphModel::connectionCreated,
+            this,
+            [this](ConnectionId const connectionId) {
+                if (batchInProgress())
+                    _batchDelta.createdConnections.insert(connectionId);
+            });
+
+    connect(this,
+            &AbstractGraphModel::connectionDeleted,
+            this,
+            [this](ConnectionId const connectionId) {
+                if (batchInProgress() && _batchDelta.createdConnections.erase(connectionId) == 0)
+                    _batchDelta.deletedConnections.insert(connectionId);
+            });
+
+    // Listeners rebuild everything after a reset anyway.
+    connect(this, &AbstractGraphModel::modelReset, this, [this]() {
+        _batchDelta = GraphChangeDelta();
+    });
+}
+
+unsigned int AbstractGraphModel::portCount(NodeId nodeId, PortType portType) const
+{
+    return nodeData<unsigned int>(nodeId,
+                                  (portType == PortType::Out) ? NodeRole::OutPortCount
+                                                              : NodeRole::InPortCount);
+}
+
+QSize AbstractGraphModel::nodeSize(NodeId nodeId) const
+{
+    return nodeData<QSize>(nodeId, NodeRole::Size);
+}
+
+QString AbstractGraphModel::nodeCaption(NodeId nodeId) const
+{
+    return nodeData<QString>(nodeId, NodeRole::Caption);
+}
+
+bool AbstractGraphModel::nodeCaptionVisible(NodeId nodeId) const
+{
+    return nodeData<bool>(nodeId, NodeRole::CaptionVisible);
+}
+
+QWidget *AbstractGraphModel::nodeWidget(NodeId nodeId) const
+{
+    return nodeData<QWidget *>(nodeId, NodeRole::Widget);
+}
+
+QString AbstractGraphModel::portCaption(NodeId nodeId, PortType portType, PortIndex index) const
+{
+    return portData<QString>(nodeId, portType, index, PortRole::Caption);
+}
+
+bool AbstractGraphModel::portCaptionVisible(NodeId nodeId,
+                                            PortType portType,
+                                            PortIndex index) const
+{
+    return portData<bool>(nodeId, portType, index, PortRole::CaptionVisible);
+}
+
+NodeDataType AbstractGraphModel::portDataType(NodeId nodeId,
+                                              PortType portType,
+                                              PortIndex index) const
+{
+    return portData<NodeDataType>(nodeId, portType, index, PortRole::DataType);
+}
+
+DataTypeHandle AbstractGraphModel::portDataTypeHandle(NodeId nodeId,
+                                                     PortType portType,
+                                                     PortIndex index) const
+{
+    return DataTypeRegistry::intern(portDataType(nodeId, portType, index));
+}
+
+void AbstractGraphModel::beginBatch()
+{
+    ++_batchDepth;
+}
+
+void AbstractGraphModel::endBatch()
+{
+    if (_batchDepth == 0 || --_batchDepth > 0)
+        return;
+
+    GraphChangeDelta delta;
+    std::swap(delta, _batchDelta);
+
+    if (!delta.empty())
+        Q_EMIT graphChanged(delta);
+}
+
 void AbstractGraphModel::portsAboutToBeDeleted(NodeId const nodeId,
                                                PortType const portType,
                                                PortIndex const first,
@@ -8,6 +8,8 @@
 #include "DefaultNodePainter.hpp"
 #include "DefaultVerticalNodeGeometry.hpp"
 #include "NodeGraphicsObject.hpp"
+#include "UndoCommands.hpp"
+#include "UndoHistory.hpp"
 
 #include <QUndoStack>
 
@@ -17,6 +19,8 @@
 #include <QWidgetAction>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QGraphicsSceneMoveEvent>
+#include <QtWidgets/QGraphicsView>
+#include <QtWidgets/QStyleOptionGraphicsItem>
 
 #include <QtCore/QBuffer>
 #include <QtCore/QByteArray>
@@ -27,6 +31,7 @@
 #include <QtCore/QJsonObject>
 #include <QtCore/QtGlobal>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <unordered_set>
@@ -43,6 +48,7 @@ BasicGraphicsScene::BasicGraphicsScene(AbstractGraphModel &graphModel, QObject *
     , _connectionPainter(std::make_unique<DefaultConnectionPainter>())
     , _nodeDrag(false)
     , _undoStack(new QUndoStack(this))
+    , _undoHistory(new UndoHistory(*_undoStack, this))
     , _orientation(Qt::Horizontal)
 {
     setItemIndexMethod(QGraphicsScene::NoIndex);
@@ -72,15 +78,21 @@ BasicGraphicsScene::BasicGraphicsScene(AbstractGraphModel &graphModel, QObject *
             this,
             &BasicGraphicsScene::onNodePositionUpdated);
 
-    connect(&_graphModel,
-            &AbstractGraphModel::nodeUpdated,
-            this,
-            &BasicGraphicsScene::onNodeUpdated);
+    // Repeated updates within a batch are applied once by onGraphChanged.
+    connect(&_graphModel, &AbstractGraphModel::nodeUpdated, this, [this](NodeId const nodeId) {
+        if (!_graphModel.batchInProgress())
+            onNodeUpdated(nodeId);
+    });
 
     connect(this, &BasicGraphicsScene::nodeClicked, this, &BasicGraphicsScene::onNodeClicked);
 
     connect(&_graphModel, &AbstractGraphModel::modelReset, this, &BasicGraphicsScene::onModelReset);
 
+    connect(&_graphModel,
+            &AbstractGraphModel::graphChanged,
+            this,
+            &BasicGraphicsScene::onGraphChanged);
+
     traverseGraphAndPopulateGraphicsObjects();
 }
 
@@ -124,6 +136,10 @@ void BasicGraphicsScene::setNodePainter(std::unique_ptr<AbstractNodePainter> new
 void BasicGraphicsScene::setConnectionPainter(std::unique_ptr<AbstractConnectionPainter> newPainter)
 {
     _connectionPainter = std::move(newPainter);
+
+    // Shapes are built by the painter.
+    for (auto &cgo : _connectionGraphicsObjects)
+        cgo.second->invalidateGeometry();
 }
 
 void BasicGraphicsScene::setNodeGeometry(std::unique_ptr<AbstractNodeGeometry> newGeom)
@@ -136,6 +152,11 @@ QUndoStack &BasicGraphicsScene::undoStack()
     return *_undoStack;
 }
 
+UndoHistory &BasicGraphicsScene::undoHistory()
+{
+    return *_undoHistory;
+}
+
 std::unique_ptr<ConnectionGraphicsObject> const &BasicGraphicsScene::makeDraftConnection(
     ConnectionId const incompleteConnectionId)
 {
@@ -160,6 +181,135 @@ void BasicGraphicsScene::clearScene()
     }
 }
 
+void BasicGraphicsScene::suspendUpdates()
+{
+    ++_suspendDepth;
+}
+
+void BasicGraphicsScene::resumeUpdates()
+{
+    if (_suspendDepth == 0 || --_suspendDepth > 0)
+        return;
+
+    // Nodes first, connection objects look up their end nodes.
+    for (NodeId const nodeId : _deferredNodes) {
+        if (_graphModel.nodeExists(nodeId))
+            _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    }
+
+    for (ConnectionId const &connectionId : _deferredConnections) {
+        if (_graphModel.connectionExists(connectionId))
+            _connectionGraphicsObjects[connectionId]
+                = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+    }
+
+    _deferredNodes.clear();
+    _deferredConnections.clear();
+
+    if (_modifiedWhileSuspended) {
+        _modifiedWhileSuspended = false;
+
+        Q_EMIT modified(this);
+    }
+}
+
+void BasicGraphicsScene::beginNodeDrag()
+{
+    if (_dragInProgress)
+        return;
+
+    _dragInProgress = true;
+    _dragOffset = QPointF();
+    _draggedNodes.clear();
+    _draggedConnections.clear();
+
+    // Connections between two dragged nodes are collected once.
+    std::unordered_set<ConnectionId> connections;
+
+    for (QGraphicsItem *item : selectedItems()) {
+        if (auto ngo = qgraphicsitem_cast<NodeGraphicsObject *>(item)) {
+            NodeId const nodeId = ngo->nodeId();
+
+            _draggedNodes.emplace_back(nodeId,
+                                       _graphModel.nodeData(nodeId, NodeRole::Position)
+                                           .value<QPointF>());
+
+            for (ConnectionId const &connectionId : _graphModel.allConnectionIds(nodeId))
+                connections.insert(connectionId);
+        }
+    }
+
+    _draggedConnections.assign(connections.begin(), connections.end());
+}
+
+void BasicGraphicsScene::dragNodes(QPointF const &diff)
+{
+    if (!_dragInProgress)
+        return;
+
+    _dragOffset += diff;
+
+    for (auto const &node : _draggedNodes) {
+        if (auto ngo = nodeGraphicsObject(node.first)) {
+            // NodeGraphicsObject::itemChange leaves the connections to us.
+            ngo->setPos(node.second + _dragOffset);
+            _spatialIndex.updateNode(node.first, ngo->sceneBoundingRect());
+        }
+    }
+
+    for (ConnectionId const &connectionId : _draggedConnections) {
+        if (auto cgo = connectionGraphicsObject(connectionId))
+            cgo->move();
+    }
+}
+
+void BasicGraphicsScene::endNodeDrag()
+{
+    if (!_dragInProgress)
+        return;
+
+    _dragInProgress = false;
+
+    std::unordered_set<NodeId> nodeIds;
+
+    for (auto const &node : _draggedNodes) {
+        if (_graphModel.nodeExists(node.first))
+            nodeIds.insert(node.first);
+    }
+
+    if (!nodeIds.empty() && !_dragOffset.isNull())
+        _undoStack->push(new MoveNodeCommand(this, nodeIds, _dragOffset));
+
+    // Picks up connections the model created while the gesture was running.
+    for (NodeId const nodeId : nodeIds) {
+        if (auto ngo = nodeGraphicsObject(nodeId))
+            ngo->moveConnections();
+    }
+
+    _draggedNodes.clear();
+    _draggedConnections.clear();
+}
+
+void BasicGraphicsScene::cancelNodeDrag()
+{
+    if (!_dragInProgress)
+        return;
+
+    _dragInProgress = false;
+
+    for (auto const &node : _draggedNodes) {
+        auto ngo = nodeGraphicsObject(node.first);
+        if (ngo && _graphModel.nodeExists(node.first)) {
+            // itemChange moves the connections again now that the gesture is over.
+            ngo->setPos(node.second);
+            _spatialIndex.updateNode(node.first, ngo->sceneBoundingRect());
+        }
+    }
+
+    _draggedNodes.clear();
+    _draggedConnections.clear();
+}
+
 NodeGraphicsObject *BasicGraphicsScene::nodeGraphicsObject(NodeId nodeId)
 {
     NodeGraphicsObject *ngo = nullptr;
@@ -201,6 +351,50 @@ void BasicGraphicsScene::setOrientation(Qt::Orientation const orientation)
     }
 }
 
+void BasicGraphicsScene::setLevelOfDetailThresholds(double const simplified, double const outline)
+{
+    _simplifiedDetailThreshold = simplified;
+    _outlineDetailThreshold = std::min(outline, simplified);
+
+    updateNodeWidgetVisibility();
+
+    update();
+}
+
+void BasicGraphicsScene::updateNodeWidgetVisibility()
+{
+    bool visible = views().isEmpty();
+
+    for (QGraphicsView const *view : views()) {
+        if (levelOfDetail(view->transform()) == LevelOfDetail::Full) {
+            visible = true;
+            break;
+        }
+    }
+
+    if (visible == _nodeWidgetsVisible)
+        return;
+
+    _nodeWidgetsVisible = visible;
+
+    for (auto &node : _nodeGraphicsObjects) {
+        node.second->setWidgetVisible(visible);
+    }
+}
+
+LevelOfDetail BasicGraphicsScene::levelOfDetail(QTransform const &worldTransform) const
+{
+    qreal const lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(worldTransform);
+
+    if (lod < _outlineDetailThreshold)
+        return LevelOfDetail::Outline;
+
+    if (lod < _simplifiedDetailThreshold)
+        return LevelOfDetail::Simplified;
+
+    return LevelOfDetail::Full;
+}
+
 QMenu *BasicGraphicsScene::createSceneMenu(QPointF const scenePos)
 {
     Q_UNUSED(scenePos);
@@ -243,24 +437,45 @@ void BasicGraphicsScene::updateAttachedNodes(ConnectionId const connectionId,
 
 void BasicGraphicsScene::onConnectionDeleted(ConnectionId const connectionId)
 {
+    if (updatesSuspended()) {
+        _deferredConnections.erase(connectionId);
+        _modifiedWhileSuspended = true;
+    }
+
     auto it = _connectionGraphicsObjects.find(connectionId);
     if (it != _connectionGraphicsObjects.end()) {
         _connectionGraphicsObjects.erase(it);
     }
 
+    _spatialIndex.removeConnection(connectionId);
+
     // TODO: do we need it?
     if (_draftConnection && _draftConnection->connectionId() == connectionId) {
         _draftConnection.reset();
     }
 
+    // The attached nodes are refreshed by onGraphChanged.
+    if (_graphModel.batchInProgress())
+        return;
+
     updateAttachedNodes(connectionId, PortType::Out);
     updateAttachedNodes(connectionId, PortType::In);
 
-    Q_EMIT modified(this);
+    if (!updatesSuspended())
+        Q_EMIT modified(this);
 }
 
 void BasicGraphicsScene::onConnectionCreated(ConnectionId const connectionId)
 {
+    if (_graphModel.batchInProgress())
+        return;
+
+    if (updatesSuspended()) {
+        _deferredConnections.insert(connectionId);
+        _modifiedWhileSuspended = true;
+        return;
+    }
+
     _connectionGraphicsObjects[connectionId]
         = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
 
@@ -272,16 +487,47 @@ void BasicGraphicsScene::onConnectionCreated(ConnectionId const connectionId)
 
 void BasicGraphicsScene::onNodeDeleted(NodeId const nodeId)
 {
+    // The grabbing node may be gone, so no release would end the gesture.
+    if (_dragInProgress
+        && std::any_of(_draggedNodes.begin(),
+                       _draggedNodes.end(),
+                       [nodeId](std::pair<NodeId, QPointF> const &node) {
+                           return node.first == nodeId;
+                       })) {
+        cancelNodeDrag();
+    }
+
+    if (updatesSuspended() && _deferredNodes.erase(nodeId) > 0)
+        _modifiedWhileSuspended = true;
+
+    _nodeGeometry->invalidate(nodeId);
+
     auto it = _nodeGraphicsObjects.find(nodeId);
     if (it != _nodeGraphicsObjects.end()) {
         _nodeGraphicsObjects.erase(it);
+        _spatialIndex.removeNode(nodeId);
 
-        Q_EMIT modified(this);
+        if (_graphModel.batchInProgress())
+            return;
+
+        if (updatesSuspended())
+            _modifiedWhileSuspended = true;
+        else
+            Q_EMIT modified(this);
     }
 }
 
 void BasicGraphicsScene::onNodeCreated(NodeId const nodeId)
 {
+    if (_graphModel.batchInProgress())
+        return;
+
+    if (updatesSuspended()) {
+        _deferredNodes.insert(nodeId);
+        _modifiedWhileSuspended = true;
+        return;
+    }
+
     _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
 
     Q_EMIT modified(this);
@@ -293,6 +539,7 @@ void BasicGraphicsScene::onNodePositionUpdated(NodeId const nodeId)
     if (node) {
         node->setPos(_graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>());
         node->update();
+        _spatialIndex.updateNode(nodeId, node->sceneBoundingRect());
         _nodeDrag = true;
     }
 }
@@ -302,9 +549,12 @@ void BasicGraphicsScene::onNodeUpdated(NodeId const nodeId)
     auto node = nodeGraphicsObject(nodeId);
 
     if (node) {
+        node->invalidateNodeStyle();
         node->setGeometryChanged();
 
+        _nodeGeometry->invalidate(nodeId);
         _nodeGeometry->recomputeSize(nodeId);
+        _spatialIndex.updateNode(nodeId, node->sceneBoundingRect());
 
         node->updateQWidgetEmbedPos();
         node->update();
@@ -312,6 +562,50 @@ void BasicGraphicsScene::onNodeUpdated(NodeId const nodeId)
     }
 }
 
+void BasicGraphicsScene::onGraphChanged(GraphChangeDelta const &delta)
+{
+    // Deleted items already lost their graphics objects, see onNodeDeleted
+    // and onConnectionDeleted.
+    for (NodeId const nodeId : delta.updatedNodes)
+        onNodeUpdated(nodeId);
+
+    if (updatesSuspended()) {
+        _deferredNodes.insert(delta.createdNodes.begin(), delta.createdNodes.end());
+        _deferredConnections.insert(delta.createdConnections.begin(),
+                                    delta.createdConnections.end());
+        _modifiedWhileSuspended = true;
+        return;
+    }
+
+    for (NodeId const nodeId : delta.createdNodes) {
+        if (_graphModel.nodeExists(nodeId) && !nodeGraphicsObject(nodeId))
+            _nodeGraphicsObjects[nodeId] = std::make_unique<NodeGraphicsObject>(*this, nodeId);
+    }
+
+    for (ConnectionId const &connectionId : delta.createdConnections) {
+        if (_graphModel.connectionExists(connectionId) && !connectionGraphicsObject(connectionId))
+            _connectionGraphicsObjects[connectionId]
+                = std::make_unique<ConnectionGraphicsObject>(*this, connectionId);
+    }
+
+    // Every node is repainted once, however many of its connections changed.
+    std::unordered_set<NodeId> attachedNodes;
+
+    for (auto const *connections : {&delta.createdConnections, &delta.deletedConnections}) {
+        for (ConnectionId const &connectionId : *connections) {
+            attachedNodes.insert(connectionId.outNodeId);
+            attachedNodes.insert(connectionId.inNodeId);
+        }
+    }
+
+    for (NodeId const nodeId : attachedNodes) {
+        if (auto node = nodeGraphicsObject(nodeId))
+            node->update();
+    }
+
+    Q_EMIT modified(this);
+}
+
 void BasicGraphicsScene::onNodeClicked(NodeId const nodeId)
 {
     if (_nodeDrag) {
@@ -323,12 +617,40 @@ void BasicGraphicsScene::onNodeClicked(NodeId const nodeId)
 
 void BasicGraphicsScene::onModelReset()
 {
+    cancelNodeDrag();
+
     _connectionGraphicsObjects.clear();
     _nodeGraphicsObjects.clear();
+    _deferredNodes.clear();
+    _deferredConnections.clear();
+    _spatialIndex.clear();
+    _nodeGeometry->invalidateAll();
 
     clear();
 
     traverseGraphAndPopulateGraphicsObjects();
 }
 
+bool BasicGraphicsScene::event(QEvent *event)
+{
+    // The default geometries measure text with the application font.
+    if (event->type() == QEvent::ApplicationFontChange) {
+        _nodeGeometry->invalidateAll();
+
+        for (auto &node : _nodeGraphicsObjects) {
+            NodeGraphicsObject *ngo = node.second.get();
+
+            ngo->setGeometryChanged();
+            _nodeGeometry->recomputeSize(node.first);
+            _spatialIndex.updateNode(node.first, ngo->sceneBoundingRect());
+
+            ngo->updateQWidgetEmbedPos();
+            ngo->update();
+            ngo->moveConnections();
+        }
+    }
+
+    return QGraphicsScene::event(event);
+}
+
 } // namespace QtNodes
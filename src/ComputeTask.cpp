@@ -0,0 +1,70 @@
+#include "ComputeTask.hpp"
+
+namespace QtNodes {
+
+void ComputeTask::cancel()
+{
+    if (_state)
+        _state->cancelled = true;
+}
+
+bool ComputeTask::isCancelled() const
+{
+    return _state && _state->cancelled;
+}
+
+bool ComputeTask::isFinished() const
+{
+    if (!_state)
+        return true;
+
+    QMutexLocker locker(&_state->mutex);
+    return _state->finished;
+}
+
+void ComputeTask::waitForFinished() const
+{
+    if (!_state)
+        return;
+
+    QMutexLocker locker(&_state->mutex);
+    while (!_state->finished)
+        _state->finishedCondition.wait(&_state->mutex);
+}
+
+quint64 ComputeTask::generation() const
+{
+    return _state ? _state->generation : 0;
+}
+
+bool ComputeTask::markStarted()
+{
+    QMutexLocker locker(&_state->mutex);
+
+    if (_state->cancelled) {
+        _state->finished = true;
+        _state->finishedCondition.wakeAll();
+        return false;
+    }
+
+    _state->started = true;
+    return true;
+}
+
+bool ComputeTask::hasStarted() const
+{
+    if (!_state)
+        return false;
+
+    QMutexLocker locker(&_state->mutex);
+    return _state->started;
+}
+
+void ComputeTask::markFinished()
+{
+    QMutexLocker locker(&_state->mutex);
+    _state->finished = true;
+    _state->finishedCondition.wakeAll();
+}
+
+} // namespace QtNodes
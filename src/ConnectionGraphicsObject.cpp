@@ -98,24 +98,9 @@ ConnectionId const &ConnectionGraphicsObject::connectionId() const
 
 QRectF ConnectionGraphicsObject::boundingRect() const
 {
-    auto points = pointsC1C2();
+    updateGeometry();
 
-    // `normalized()` fixes inverted rects.
-    QRectF basicRect = QRectF(_out, _in).normalized();
-
-    QRectF c1c2Rect = QRectF(points.first, points.second).normalized();
-
-    QRectF commonRect = basicRect.united(c1c2Rect);
-
-    auto const &connectionStyle = StyleCollection::connectionStyle();
-    float const diam = connectionStyle.pointDiameter();
-    QPointF const cornerOffset(diam, diam);
-
-    // Expand rect by port circle diameter
-    commonRect.setTopLeft(commonRect.topLeft() - cornerOffset);
-    commonRect.setBottomRight(commonRect.bottomRight() + 2 * cornerOffset);
-
-    return commonRect;
+    return _boundingRect;
 }
 
 QPainterPath ConnectionGraphicsObject::shape() const
@@ -128,10 +113,26 @@ QPainterPath ConnectionGraphicsObject::shape() const
     //return path;
 
 #else
-    return nodeScene()->connectionPainter().getPainterStroke(*this);
+    updateGeometry();
+
+    // Hover and hit tests ask for the shape far more often than the
+    // connection moves.
+    if (!_shapeValid) {
+        _shape = nodeScene()->connectionPainter().getPainterStroke(*this);
+        _shapeValid = true;
+    }
+
+    return _shape;
 #endif
 }
 
+QPainterPath const &ConnectionGraphicsObject::cubicPath() const
+{
+    updateGeometry();
+
+    return _cubicPath;
+}
+
 QPointF const &ConnectionGraphicsObject::endPoint(PortType portType) const
 {
     Q_ASSERT(portType != PortType::None);
@@ -141,10 +142,14 @@ QPointF const &ConnectionGraphicsObject::endPoint(PortType portType) const
 
 void ConnectionGraphicsObject::setEndPoint(PortType portType, QPointF const &point)
 {
-    if (portType == PortType::In)
-        _in = point;
-    else
-        _out = point;
+    QPointF &end = (portType == PortType::In ? _in : _out);
+
+    if (end == point)
+        return;
+
+    end = point;
+
+    invalidateGeometry();
 }
 
 void ConnectionGraphicsObject::move()
@@ -176,6 +181,10 @@ void ConnectionGraphicsObject::move()
 
     prepareGeometryChange();
 
+    // Draft connections are not part of the graph and are not indexed.
+    if (_connectionId.outNodeId != InvalidNodeId && _connectionId.inNodeId != InvalidNodeId)
+        nodeScene()->spatialIndex().updateConnection(_connectionId, sceneBoundingRect());
+
     update();
 }
 
@@ -198,7 +207,18 @@ void ConnectionGraphicsObject::paint(QPainter *painter,
 
     painter->setClipRect(option->exposedRect);
 
+    RenderDiagnostics &diagnostics = nodeScene()->renderDiagnostics();
+
+    if (!diagnostics.isEnabled()) {
+        nodeScene()->connectionPainter().paint(painter, *this);
+        return;
+    }
+
+    qint64 const start = diagnostics.now();
+
     nodeScene()->connectionPainter().paint(painter, *this);
+
+    diagnostics.recordConnectionPaint(diagnostics.now() - start);
 }
 
 void ConnectionGraphicsObject::mousePressEvent(QGraphicsSceneMouseEvent *event)
@@ -302,6 +322,49 @@ std::pair<QPointF, QPointF> ConnectionGraphicsObject::pointsC1C2() const
     throw std::logic_error("Unreachable code after switch statement");
 }
 
+void ConnectionGraphicsObject::invalidateGeometry()
+{
+    _geometryValid = false;
+    _shapeValid = false;
+}
+
+void ConnectionGraphicsObject::updateGeometry() const
+{
+    Qt::Orientation const orientation = nodeScene() ? nodeScene()->orientation()
+                                                    : _cachedOrientation;
+
+    if (_geometryValid && orientation == _cachedOrientation)
+        return;
+
+    _cachedOrientation = orientation;
+    _shapeValid = false;
+
+    auto const points = pointsC1C2();
+
+    // cubic spline
+    _cubicPath = QPainterPath(_out);
+    _cubicPath.cubicTo(points.first, points.second, _in);
+
+    // `normalized()` fixes inverted rects.
+    QRectF basicRect = QRectF(_out, _in).normalized();
+
+    QRectF c1c2Rect = QRectF(points.first, points.second).normalized();
+
+    QRectF commonRect = basicRect.united(c1c2Rect);
+
+    auto const &connectionStyle = StyleCollection::connectionStyle();
+    float const diam = connectionStyle.pointDiameter();
+    QPointF const cornerOffset(diam, diam);
+
+    // Expand rect by port circle diameter
+    commonRect.setTopLeft(commonRect.topLeft() - cornerOffset);
+    commonRect.setBottomRight(commonRect.bottomRight() + 2 * cornerOffset);
+
+    _boundingRect = commonRect;
+
+    _geometryValid = true;
+}
+
 void ConnectionGraphicsObject::addGraphicsEffect()
 {
     auto effect = new QGraphicsBlurEffect;
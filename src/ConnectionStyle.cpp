@@ -120,6 +120,15 @@ void ConnectionStyle::loadJson(QJsonObject const &json)
     CONNECTION_STYLE_READ_FLOAT(obj, PointDiameter);
 
     CONNECTION_STYLE_READ_BOOL(obj, UseDataDefinedColors);
+
+    QJsonObject const typeColors = obj["DataTypeColors"].toObject();
+
+    for (auto it = typeColors.begin(); it != typeColors.end(); ++it) {
+        QColor const color(it.value().toString());
+
+        if (color.isValid())
+            setTypeColor(it.key(), color);
+    }
 }
 
 QJsonObject ConnectionStyle::toJson() const
@@ -138,6 +147,15 @@ QJsonObject ConnectionStyle::toJson() const
 
     CONNECTION_STYLE_WRITE_BOOL(obj, UseDataDefinedColors);
 
+    if (!_typeColorOverrides.isEmpty()) {
+        QJsonObject typeColors;
+
+        for (auto it = _typeColorOverrides.cbegin(); it != _typeColorOverrides.cend(); ++it)
+            typeColors[it.key()] = it.value().name();
+
+        obj["DataTypeColors"] = typeColors;
+    }
+
     QJsonObject root;
     root["ConnectionStyle"] = obj;
 
@@ -155,6 +173,50 @@ QColor ConnectionStyle::normalColor() const
 }
 
 QColor ConnectionStyle::normalColor(QString typeId) const
+{
+    auto overrideIt = _typeColorOverrides.constFind(typeId);
+    if (overrideIt != _typeColorOverrides.constEnd())
+        return overrideIt.value();
+
+    auto it = _typeColorCache.constFind(typeId);
+    if (it != _typeColorCache.constEnd())
+        return it.value();
+
+    QColor const color = generatedTypeColor(typeId);
+
+    _typeColorCache.insert(typeId, color);
+
+    return color;
+}
+
+QColor ConnectionStyle::normalColor(DataTypeHandle const typeHandle) const
+{
+    if (typeHandle < _handleColorCache.size() && _handleColorCache[typeHandle].isValid())
+        return _handleColorCache[typeHandle];
+
+    QColor const color = normalColor(DataTypeRegistry::typeId(typeHandle));
+
+    if (typeHandle >= _handleColorCache.size())
+        _handleColorCache.resize(typeHandle + 1);
+
+    _handleColorCache[typeHandle] = color;
+
+    return color;
+}
+
+void ConnectionStyle::setTypeColor(QString const &typeId, QColor const &color)
+{
+    _typeColorOverrides.insert(typeId, color);
+    _handleColorCache.clear();
+}
+
+void ConnectionStyle::resetTypeColor(QString const &typeId)
+{
+    _typeColorOverrides.remove(typeId);
+    _handleColorCache.clear();
+}
+
+QColor ConnectionStyle::generatedTypeColor(QString const &typeId)
 {
     std::size_t hash = qHash(typeId);
 
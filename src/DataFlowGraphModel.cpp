@@ -4,8 +4,21 @@
 #include "Definitions.hpp"
 
 #include <QJsonArray>
-
-#include <stack>
+#include <QJsonDocument>
+#include <QtCore/QDataStream>
+#include <QtCore/QIODevice>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QtCore/QCborValue>
+#endif
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
 #include <stdexcept>
 
 namespace QtNodes {
@@ -25,33 +38,24 @@ std::unordered_set<NodeId> DataFlowGraphModel::allNodeIds() const
 
 std::unordered_set<ConnectionId> DataFlowGraphModel::allConnectionIds(NodeId const nodeId) const
 {
-    std::unordered_set<ConnectionId> result;
+    auto it = _nodeConnections.find(nodeId);
 
-    std::copy_if(_connectivity.begin(),
-                 _connectivity.end(),
-                 std::inserter(result, std::end(result)),
-                 [&nodeId](ConnectionId const &cid) {
-                     return cid.inNodeId == nodeId || cid.outNodeId == nodeId;
-                 });
+    if (it == _nodeConnections.end())
+        return {};
 
-    return result;
+    return it->second;
 }
 
 std::unordered_set<ConnectionId> DataFlowGraphModel::connections(NodeId nodeId,
                                                                  PortType portType,
                                                                  PortIndex portIndex) const
 {
-    std::unordered_set<ConnectionId> result;
+    auto it = _portConnections.find(PortKey{nodeId, portType, portIndex});
 
-    std::copy_if(_connectivity.begin(),
-                 _connectivity.end(),
-                 std::inserter(result, std::end(result)),
-                 [&portType, &portIndex, &nodeId](ConnectionId const &cid) {
-                     return (getNodeId(portType, cid) == nodeId
-                             && getPortIndex(portType, cid) == portIndex);
-                 });
+    if (it == _portConnections.end())
+        return {};
 
-    return result;
+    return it->second;
 }
 
 bool DataFlowGraphModel::connectionExists(ConnectionId const connectionId) const
@@ -76,6 +80,7 @@ NodeId DataFlowGraphModel::addNode(QString const nodeType)
                 &NodeDelegateModel::portsAboutToBeDeleted,
                 this,
                 [newId, this](PortType const portType, PortIndex const first, PortIndex const last) {
+                    ++_structureVersion;
                     portsAboutToBeDeleted(newId, portType, first, last);
                 });
 
@@ -88,6 +93,7 @@ NodeId DataFlowGraphModel::addNode(QString const nodeType)
                 &NodeDelegateModel::portsAboutToBeInserted,
                 this,
                 [newId, this](PortType const portType, PortIndex const first, PortIndex const last) {
+                    ++_structureVersion;
                     portsAboutToBeInserted(newId, portType, first, last);
                 });
 
@@ -100,7 +106,25 @@ NodeId DataFlowGraphModel::addNode(QString const nodeType)
             Q_EMIT nodeUpdated(newId);
         });
 
+        connect(model.get(),
+                &NodeDelegateModel::computeTimed,
+                this,
+                [newId, this](qint64 startNs,
+                              qint64 durationNs,
+                              quint64 generation,
+                              Qt::HANDLE thread) {
+                    if (_profiler.isEnabled())
+                        _profiler.recordCompute(newId,
+                                                _profiler.fromSteadyClock(startNs),
+                                                durationNs,
+                                                generation,
+                                                thread);
+                });
+
         _models[newId] = std::move(model);
+        ++_structureVersion;
+
+        _topology.addNode(newId);
 
         Q_EMIT nodeCreated(newId);
 
@@ -120,20 +144,14 @@ bool DataFlowGraphModel::connectionPossible(ConnectionId const connectionId) con
     // Check port bounds, i.e. that we do not connect non-existing port numbers
     auto checkPortBounds = [&](PortType const portType) {
         NodeId const nodeId = getNodeId(portType, connectionId);
-        auto portCountRole = (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                         : NodeRole::InPortCount;
-
-        std::size_t const portCount = nodeData(nodeId, portCountRole).toUInt();
 
-        return getPortIndex(portType, connectionId) < portCount;
+        return getPortIndex(portType, connectionId) < portCount(nodeId, portType);
     };
 
     auto getDataType = [&](PortType const portType) {
-        return portData(getNodeId(portType, connectionId),
-                        portType,
-                        getPortIndex(portType, connectionId),
-                        PortRole::DataType)
-            .value<NodeDataType>();
+        return portDataTypeHandle(getNodeId(portType, connectionId),
+                                  portType,
+                                  getPortIndex(portType, connectionId));
     };
 
     auto portVacant = [&](PortType const portType) {
@@ -147,39 +165,15 @@ bool DataFlowGraphModel::connectionPossible(ConnectionId const connectionId) con
         return connected.empty() || (policy == ConnectionPolicy::Many);
     };
 
-    bool const basicChecks = getDataType(PortType::Out).id == getDataType(PortType::In).id
+    bool const basicChecks = getDataType(PortType::Out) == getDataType(PortType::In)
                              && portVacant(PortType::Out) && portVacant(PortType::In)
                              && checkPortBounds(PortType::Out) && checkPortBounds(PortType::In);
 
     // In data-flow mode (this class) it's important to forbid graph loops.
-    // We perform depth-first graph traversal starting from the "Input" port of
-    // the given connection. We should never encounter the starting "Out" node.
-
+    // The maintained topological order answers most queries without any
+    // traversal and limits the rest to the nodes ranked between the two ends.
     auto hasLoops = [this, &connectionId]() -> bool {
-        std::stack<NodeId> filo;
-        filo.push(connectionId.inNodeId);
-
-        while (!filo.empty()) {
-            auto id = filo.top();
-            filo.pop();
-
-            if (id == connectionId.outNodeId) { // LOOP!
-                return true;
-            }
-
-            // Add out-connections to continue interations
-            std::size_t const nOutPorts = nodeData(id, NodeRole::OutPortCount).toUInt();
-
-            for (PortIndex index = 0; index < nOutPorts; ++index) {
-                auto const &outConnectionIds = connections(id, PortType::Out, index);
-
-                for (auto cid : outConnectionIds) {
-                    filo.push(cid.inNodeId);
-                }
-            }
-        }
-
-        return false;
+        return _topology.wouldCreateCycle(connectionId.outNodeId, connectionId.inNodeId);
     };
 
     return basicChecks && (loopsEnabled() || !hasLoops());
@@ -187,7 +181,15 @@ bool DataFlowGraphModel::connectionPossible(ConnectionId const connectionId) con
 
 void DataFlowGraphModel::addConnection(ConnectionId const connectionId)
 {
-    _connectivity.insert(connectionId);
+    if (_connectivity.insert(connectionId).second) {
+        indexConnection(connectionId);
+
+        _topology.addEdge(connectionId.outNodeId, connectionId.inNodeId);
+
+        // The edge may have moved nodes that are already queued.
+        if (!_updateQueue.empty())
+            _updateQueueStale = true;
+    }
 
     sendConnectionCreation(connectionId);
 
@@ -196,11 +198,45 @@ void DataFlowGraphModel::addConnection(ConnectionId const connectionId)
                                                   connectionId.outPortIndex,
                                                   PortRole::Data);
 
-    setPortData(connectionId.inNodeId,
-                PortType::In,
-                connectionId.inPortIndex,
-                portDataToPropagate,
-                PortRole::Data);
+    scheduleInPortData(connectionId.inNodeId, connectionId.inPortIndex, portDataToPropagate);
+}
+
+void DataFlowGraphModel::indexConnection(ConnectionId const connectionId)
+{
+    _portConnections[PortKey{connectionId.outNodeId, PortType::Out, connectionId.outPortIndex}]
+        .insert(connectionId);
+    _portConnections[PortKey{connectionId.inNodeId, PortType::In, connectionId.inPortIndex}]
+        .insert(connectionId);
+
+    _nodeConnections[connectionId.outNodeId].insert(connectionId);
+    _nodeConnections[connectionId.inNodeId].insert(connectionId);
+
+    ++_structureVersion;
+}
+
+void DataFlowGraphModel::unindexConnection(ConnectionId const connectionId)
+{
+    auto eraseFrom = [&connectionId](auto &index, auto const &key) {
+        auto it = index.find(key);
+        if (it == index.end())
+            return;
+
+        it->second.erase(connectionId);
+
+        // Empty buckets are dropped to keep the index proportional to the graph.
+        if (it->second.empty())
+            index.erase(it);
+    };
+
+    eraseFrom(_portConnections,
+              PortKey{connectionId.outNodeId, PortType::Out, connectionId.outPortIndex});
+    eraseFrom(_portConnections,
+              PortKey{connectionId.inNodeId, PortType::In, connectionId.inPortIndex});
+
+    eraseFrom(_nodeConnections, connectionId.outNodeId);
+    eraseFrom(_nodeConnections, connectionId.inNodeId);
+
+    ++_structureVersion;
 }
 
 void DataFlowGraphModel::sendConnectionCreation(ConnectionId const connectionId)
@@ -318,6 +354,16 @@ NodeFlags DataFlowGraphModel::nodeFlags(NodeId nodeId) const
     return NodeFlag::NoFlags;
 }
 
+NodeStyle const *DataFlowGraphModel::nodeStyle(NodeId const nodeId) const
+{
+    auto it = _models.find(nodeId);
+
+    if (it == _models.end())
+        return nullptr;
+
+    return &it->second->nodeStyle();
+}
+
 bool DataFlowGraphModel::setNodeData(NodeId nodeId, NodeRole role, QVariant value)
 {
     Q_UNUSED(nodeId);
@@ -428,6 +474,95 @@ QVariant DataFlowGraphModel::portData(NodeId nodeId,
     return result;
 }
 
+DataTypeHandle DataFlowGraphModel::portDataTypeHandle(NodeId nodeId,
+                                                     PortType portType,
+                                                     PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return InvalidDataTypeHandle;
+
+    return it->second->dataTypeHandle(portType, portIndex);
+}
+
+unsigned int DataFlowGraphModel::portCount(NodeId nodeId, PortType portType) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return 0;
+
+    return it->second->nPorts(portType);
+}
+
+QSize DataFlowGraphModel::nodeSize(NodeId nodeId) const
+{
+    auto it = _nodeGeometryData.find(nodeId);
+    if (it == _nodeGeometryData.end())
+        return QSize();
+
+    return it->second.size;
+}
+
+QString DataFlowGraphModel::nodeCaption(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return QString();
+
+    return it->second->caption();
+}
+
+bool DataFlowGraphModel::nodeCaptionVisible(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return false;
+
+    return it->second->captionVisible();
+}
+
+QWidget *DataFlowGraphModel::nodeWidget(NodeId nodeId) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return nullptr;
+
+    return it->second->embeddedWidget();
+}
+
+QString DataFlowGraphModel::portCaption(NodeId nodeId,
+                                        PortType portType,
+                                        PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return QString();
+
+    return it->second->portCaption(portType, portIndex);
+}
+
+bool DataFlowGraphModel::portCaptionVisible(NodeId nodeId,
+                                            PortType portType,
+                                            PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return false;
+
+    return it->second->portCaptionVisible(portType, portIndex);
+}
+
+NodeDataType DataFlowGraphModel::portDataType(NodeId nodeId,
+                                              PortType portType,
+                                              PortIndex portIndex) const
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return NodeDataType();
+
+    return it->second->dataType(portType, portIndex);
+}
+
 bool DataFlowGraphModel::setPortData(
     NodeId nodeId, PortType portType, PortIndex portIndex, QVariant const &value, PortRole role)
 {
@@ -444,8 +579,15 @@ bool DataFlowGraphModel::setPortData(
     switch (role) {
     case PortRole::Data:
         if (portType == PortType::In) {
+            ComputeTask const previous = model->currentCompute();
+
             model->setInData(value.value<std::shared_ptr<NodeData>>(), portIndex);
 
+            // A computation still running for the previous inputs is stale
+            // now, unless startCompute() superseded it with a new one.
+            if (previous.isValid() && model->currentCompute() == previous)
+                model->cancelCompute();
+
             // Triggers repainting on the scene.
             Q_EMIT inPortDataWasSet(nodeId, portType, portIndex);
         }
@@ -468,6 +610,14 @@ bool DataFlowGraphModel::deleteConnection(ConnectionId const connectionId)
         disconnected = true;
 
         _connectivity.erase(it);
+
+        unindexConnection(connectionId);
+
+        _topology.removeEdge(connectionId.outNodeId, connectionId.inNodeId);
+
+        // Breaking a forced cycle recomputes all ranks.
+        if (!_updateQueue.empty())
+            _updateQueueStale = true;
     }
 
     if (disconnected) {
@@ -490,6 +640,10 @@ bool DataFlowGraphModel::deleteNode(NodeId const nodeId)
 
     _nodeGeometryData.erase(nodeId);
     _models.erase(nodeId);
+    ++_structureVersion;
+    _topology.removeNode(nodeId);
+    _pendingUpdates.erase(nodeId);
+    _profiler.removeNode(nodeId);
 
     Q_EMIT nodeDeleted(nodeId);
 
@@ -546,9 +700,17 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
     // because all the new ids were created past the removed nodes.
     NodeId restoredNodeId = nodeJson["id"].toInt();
 
-    _nextNodeId = std::max(_nextNodeId, restoredNodeId + 1);
+    QJsonObject posJson = nodeJson["position"].toObject();
+    QPointF const pos(posJson["x"].toDouble(), posJson["y"].toDouble());
 
-    QJsonObject const internalDataJson = nodeJson["internal-data"].toObject();
+    restoreNode(restoredNodeId, pos, nodeJson["internal-data"].toObject());
+}
+
+void DataFlowGraphModel::restoreNode(NodeId const restoredNodeId,
+                                     QPointF const &pos,
+                                     QJsonObject const &internalDataJson)
+{
+    _nextNodeId = std::max(_nextNodeId, restoredNodeId + 1);
 
     QString delegateModelName = internalDataJson["model-name"].toString();
 
@@ -566,6 +728,7 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
                 this,
                 [restoredNodeId,
                  this](PortType const portType, PortIndex const first, PortIndex const last) {
+                    ++_structureVersion;
                     portsAboutToBeDeleted(restoredNodeId, portType, first, last);
                 });
 
@@ -579,6 +742,7 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
                 this,
                 [restoredNodeId,
                  this](PortType const portType, PortIndex const first, PortIndex const last) {
+                    ++_structureVersion;
                     portsAboutToBeInserted(restoredNodeId, portType, first, last);
                 });
 
@@ -590,12 +754,27 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
             Q_EMIT nodeUpdated(restoredNodeId);
         });
 
+        connect(model.get(),
+                &NodeDelegateModel::computeTimed,
+                this,
+                [restoredNodeId, this](qint64 startNs,
+                                       qint64 durationNs,
+                                       quint64 generation,
+                                       Qt::HANDLE thread) {
+                    if (_profiler.isEnabled())
+                        _profiler.recordCompute(restoredNodeId,
+                                                _profiler.fromSteadyClock(startNs),
+                                                durationNs,
+                                                generation,
+                                                thread);
+                });
+
         _models[restoredNodeId] = std::move(model);
+        ++_structureVersion;
 
-        Q_EMIT nodeCreated(restoredNodeId);
+        _topology.addNode(restoredNodeId);
 
-        QJsonObject posJson = nodeJson["position"].toObject();
-        QPointF const pos(posJson["x"].toDouble(), posJson["y"].toDouble());
+        Q_EMIT nodeCreated(restoredNodeId);
 
         setNodeData(restoredNodeId, NodeRole::Position, pos);
 
@@ -606,44 +785,850 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
     }
 }
 
+namespace {
+
+/**
+ * Runs `restore` inside a propagation transaction that is closed even if
+ * `restore` throws, e.g. for an unregistered node model. Whatever was
+ * restored before the error is evaluated as usual.
+ */
+template<typename Restore>
+void inUpdateTransaction(DataFlowGraphModel &model, Restore const &restore)
+{
+    model.beginUpdate();
+
+    try {
+        restore();
+    } catch (...) {
+        model.endUpdate();
+        throw;
+    }
+
+    model.endUpdate();
+}
+
+} // namespace
+
 void DataFlowGraphModel::load(QJsonObject const &jsonDocument)
 {
-    QJsonArray nodesJsonArray = jsonDocument["nodes"].toArray();
+    GraphChangeBatch batch(*this);
+
+    // Restored nodes and connections are evaluated once all of them exist.
+    inUpdateTransaction(*this, [&]() {
+        QJsonArray nodesJsonArray = jsonDocument["nodes"].toArray();
+
+        for (QJsonValueRef nodeJson : nodesJsonArray) {
+            loadNode(nodeJson.toObject());
+        }
+
+        QJsonArray connectionJsonArray = jsonDocument["connections"].toArray();
+
+        for (QJsonValueRef connection : connectionJsonArray) {
+            QJsonObject connJson = connection.toObject();
+
+            ConnectionId connId = fromJson(connJson);
+
+            // Restore the connection
+            addConnection(connId);
+        }
+    });
+}
 
-    for (QJsonValueRef nodeJson : nodesJsonArray) {
-        loadNode(nodeJson.toObject());
+namespace {
+
+/*
+ * Layout of the binary format, all numbers little-endian:
+ *
+ *   header      "QNFB", quint16 version, quint16 flags,
+ *               quint32 node count, quint32 connection count
+ *   node table  per node: quint32 id, double x, double y, quint32 blob size
+ *   connections per connection: quint32 outNodeId, outPortIndex, inNodeId, inPortIndex
+ *   blobs       the nodes' "internal-data" objects in node table order
+ */
+char const BinaryMagic[4] = {'Q', 'N', 'F', 'B'};
+
+quint16 const BinaryVersion = 1;
+
+/// Blobs are CBOR encoded, compact JSON text otherwise.
+quint16 const BinaryFlagCbor = 0x1;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+quint16 const NativeBlobFlags = BinaryFlagCbor;
+#else
+quint16 const NativeBlobFlags = 0;
+#endif
+
+QByteArray encodeBlob(QJsonObject const &json)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    return QCborValue::fromJsonValue(json).toCbor();
+#else
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+#endif
+}
+
+bool decodeBlob(QByteArray const &blob, quint16 const flags, QJsonObject &json)
+{
+    if (flags & BinaryFlagCbor) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        QCborParserError error;
+        QCborValue const value = QCborValue::fromCbor(blob, &error);
+
+        if (error.error != QCborError::NoError || !value.isMap())
+            return false;
+
+        json = value.toJsonValue().toObject();
+        return true;
+#else
+        return false;
+#endif
     }
 
-    QJsonArray connectionJsonArray = jsonDocument["connections"].toArray();
+    QJsonParseError error;
+    json = QJsonDocument::fromJson(blob, &error).object();
+
+    return error.error == QJsonParseError::NoError;
+}
+
+} // namespace
+
+QByteArray DataFlowGraphModel::saveNodeState(NodeId const nodeId) const
+{
+    return encodeBlob(_models.at(nodeId)->save());
+}
+
+void DataFlowGraphModel::restoreNodeState(NodeId const nodeId,
+                                          QPointF const &position,
+                                          QByteArray const &state)
+{
+    QJsonObject internalData;
+
+    // A default-state node would silently replace the saved one.
+    if (!decodeBlob(state, NativeBlobFlags, internalData))
+        throw std::logic_error("Damaged node state blob");
+
+    restoreNode(nodeId, position, internalData);
+}
+
+bool DataFlowGraphModel::saveBinary(QIODevice &device) const
+{
+    QDataStream out(&device);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint16 const flags = NativeBlobFlags;
 
-    for (QJsonValueRef connection : connectionJsonArray) {
-        QJsonObject connJson = connection.toObject();
+    out.writeRawData(BinaryMagic, sizeof(BinaryMagic));
+    out << BinaryVersion << flags;
+    out << static_cast<quint32>(_models.size()) << static_cast<quint32>(_connectivity.size());
 
-        ConnectionId connId = fromJson(connJson);
+    std::vector<QByteArray> blobs;
+    blobs.reserve(_models.size());
 
-        // Restore the connection
-        addConnection(connId);
+    for (auto const &m : _models) {
+        NodeId const nodeId = m.first;
+
+        auto geometryIt = _nodeGeometryData.find(nodeId);
+        QPointF const pos = geometryIt != _nodeGeometryData.end() ? geometryIt->second.pos
+                                                                  : QPointF();
+
+        blobs.push_back(encodeBlob(m.second->save()));
+
+        out << static_cast<quint32>(nodeId) << pos.x() << pos.y()
+            << static_cast<quint32>(blobs.back().size());
     }
+
+    for (auto const &cid : _connectivity) {
+        out << static_cast<quint32>(cid.outNodeId) << static_cast<quint32>(cid.outPortIndex)
+            << static_cast<quint32>(cid.inNodeId) << static_cast<quint32>(cid.inPortIndex);
+    }
+
+    for (auto const &blob : blobs) {
+        out.writeRawData(blob.constData(), blob.size());
+    }
+
+    return out.status() == QDataStream::Ok;
 }
 
-void DataFlowGraphModel::onOutPortDataUpdated(NodeId const nodeId, PortIndex const portIndex)
+namespace {
+
+struct BinaryNodeRecord
+{
+    NodeId id;
+    QPointF pos;
+    quint32 blobSize;
+};
+
+/// Bytes left on the device. Sizes read from a file are checked against it
+/// before anything is allocated for them.
+qint64 remainingBytes(QIODevice const &device)
+{
+    return device.isSequential() ? device.bytesAvailable() : device.size() - device.pos();
+}
+
+/// Reads everything up to the blob section.
+bool readBinaryTables(QDataStream &in,
+                      quint16 &flags,
+                      std::vector<BinaryNodeRecord> &nodes,
+                      std::vector<ConnectionId> &connectionIds)
+{
+    char magic[sizeof(BinaryMagic)];
+    if (in.readRawData(magic, sizeof(magic)) != static_cast<int>(sizeof(magic))
+        || !std::equal(std::begin(magic), std::end(magic), std::begin(BinaryMagic)))
+        return false;
+
+    quint16 version = 0;
+    quint32 nodeCount = 0;
+    quint32 connectionCount = 0;
+
+    in >> version >> flags >> nodeCount >> connectionCount;
+
+    if (in.status() != QDataStream::Ok || version > BinaryVersion)
+        return false;
+
+    // Counts come from the file, the vectors grow only as records are read.
+    quint64 blobsSize = 0;
+
+    for (quint32 i = 0; i < nodeCount && in.status() == QDataStream::Ok; ++i) {
+        quint32 id = 0;
+        double x = 0.0;
+        double y = 0.0;
+        quint32 blobSize = 0;
+
+        in >> id >> x >> y >> blobSize;
+        nodes.push_back(BinaryNodeRecord{static_cast<NodeId>(id), QPointF(x, y), blobSize});
+
+        blobsSize += blobSize;
+    }
+
+    for (quint32 i = 0; i < connectionCount && in.status() == QDataStream::Ok; ++i) {
+        quint32 outNodeId = 0;
+        quint32 outPortIndex = 0;
+        quint32 inNodeId = 0;
+        quint32 inPortIndex = 0;
+
+        in >> outNodeId >> outPortIndex >> inNodeId >> inPortIndex;
+        connectionIds.push_back(ConnectionId{outNodeId, outPortIndex, inNodeId, inPortIndex});
+    }
+
+    // The blobs follow the tables, a file cannot promise more than it holds.
+    return in.status() == QDataStream::Ok
+           && blobsSize <= static_cast<quint64>(std::max<qint64>(remainingBytes(*in.device()), 0));
+}
+
+bool readBlob(QIODevice &device,
+              BinaryNodeRecord const &record,
+              quint16 const flags,
+              QJsonObject &internalData)
+{
+    // QIODevice::read() allocates the requested size up front.
+    if (record.blobSize > remainingBytes(device))
+        return false;
+
+    QByteArray const blob = device.read(record.blobSize);
+
+    return static_cast<quint32>(blob.size()) == record.blobSize
+           && decodeBlob(blob, flags, internalData);
+}
+
+} // namespace
+
+bool DataFlowGraphModel::loadBinary(QIODevice &device)
+{
+    QDataStream in(&device);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint16 flags = 0;
+    std::vector<BinaryNodeRecord> nodes;
+    std::vector<ConnectionId> connectionIds;
+
+    if (!readBinaryTables(in, flags, nodes, connectionIds))
+        return false;
+
+    // Blobs are decoded up front so that a damaged file leaves the model intact.
+    std::vector<QJsonObject> internalData(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        if (!readBlob(device, nodes[i], flags, internalData[i]))
+            return false;
+    }
+
+    GraphChangeBatch batch(*this);
+
+    // Restored nodes and connections are evaluated once all of them exist.
+    inUpdateTransaction(*this, [&]() {
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            restoreNode(nodes[i].id, nodes[i].pos, internalData[i]);
+        }
+
+        for (auto const &connId : connectionIds) {
+            addConnection(connId);
+        }
+    });
+
+    return true;
+}
+
+bool DataFlowGraphModel::loadIncrementally(QIODevice &device,
+                                           LoadProgressCallback const &progress,
+                                           std::size_t const chunkSize)
+{
+    std::size_t total = 0;
+    std::size_t restored = 0;
+
+    auto advance = [&]() {
+        ++restored;
+
+        if (progress && (restored % std::max<std::size_t>(chunkSize, 1) == 0 || restored == total))
+            progress(restored, total);
+    };
+
+    if (isBinaryFormat(device)) {
+        QDataStream in(&device);
+        in.setByteOrder(QDataStream::LittleEndian);
+        in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+        quint16 flags = 0;
+        std::vector<BinaryNodeRecord> nodes;
+        std::vector<ConnectionId> connectionIds;
+
+        if (!readBinaryTables(in, flags, nodes, connectionIds))
+            return false;
+
+        total = nodes.size() + connectionIds.size();
+
+        GraphChangeBatch batch(*this);
+
+        // Blobs are consumed one by one, the file is never held in memory.
+        bool ok = true;
+
+        inUpdateTransaction(*this, [&]() {
+            for (std::size_t i = 0; ok && i < nodes.size(); ++i) {
+                QJsonObject internalData;
+
+                ok = readBlob(device, nodes[i], flags, internalData);
+
+                if (ok) {
+                    restoreNode(nodes[i].id, nodes[i].pos, internalData);
+                    advance();
+                }
+            }
+
+            for (std::size_t i = 0; ok && i < connectionIds.size(); ++i) {
+                addConnection(connectionIds[i]);
+                advance();
+            }
+        });
+
+        return ok;
+    }
+
+    // QJsonDocument has no incremental parser, the insertion is still chunked.
+    QJsonParseError error;
+    QJsonObject const json = QJsonDocument::fromJson(device.readAll(), &error).object();
+
+    if (error.error != QJsonParseError::NoError)
+        return false;
+
+    QJsonArray const nodesJsonArray = json["nodes"].toArray();
+    QJsonArray const connectionJsonArray = json["connections"].toArray();
+
+    total = nodesJsonArray.size() + connectionJsonArray.size();
+
+    GraphChangeBatch batch(*this);
+
+    inUpdateTransaction(*this, [&]() {
+        for (QJsonValue const nodeJson : nodesJsonArray) {
+            loadNode(nodeJson.toObject());
+            advance();
+        }
+
+        for (QJsonValue const connection : connectionJsonArray) {
+            addConnection(fromJson(connection.toObject()));
+            advance();
+        }
+    });
+
+    return true;
+}
+
+bool DataFlowGraphModel::isBinaryFormat(QIODevice &device)
+{
+    return device.peek(sizeof(BinaryMagic)) == QByteArray(BinaryMagic, sizeof(BinaryMagic));
+}
+
+void DataFlowGraphModel::beginUpdate()
+{
+    ++_updateDepth;
+}
+
+void DataFlowGraphModel::endUpdate()
+{
+    if (_updateDepth == 0)
+        return;
+
+    if (--_updateDepth == 0)
+        flushUpdates();
+}
+
+DataFlowGraphModel::PendingUpdate &DataFlowGraphModel::pendingUpdate(NodeId const nodeId)
+{
+    auto it = _pendingUpdates.find(nodeId);
+
+    if (it == _pendingUpdates.end()) {
+        it = _pendingUpdates.emplace(nodeId, PendingUpdate{}).first;
+
+        _updateQueue.emplace(_topology.rank(nodeId), nodeId);
+    }
+
+    return it->second;
+}
+
+void DataFlowGraphModel::scheduleInPortData(NodeId const nodeId,
+                                            PortIndex const portIndex,
+                                            QVariant const &data)
+{
+    pendingUpdate(nodeId).inPorts[portIndex] = data;
+
+    if (_updateDepth == 0)
+        flushUpdates();
+}
+
+void DataFlowGraphModel::flushUpdates()
+{
+    // Changes reported while flushing are queued behind the current node.
+    ++_updateDepth;
+
+    // Waves need a valid order. Whatever they leave behind, e.g. nodes made
+    // pending by side effects outside the affected part of the graph, is
+    // drained in rank order.
+    try {
+        if (_executionMode == ExecutionMode::Parallel && _topology.isValid())
+            flushInWaves();
+
+        flushInOrder();
+    } catch (...) {
+        --_updateDepth;
+        throw;
+    }
+
+    --_updateDepth;
+}
+
+void DataFlowGraphModel::flushInOrder()
+{
+    // With a forced cycle the ranks are meaningless and the propagation would
+    // never settle. Every node is then evaluated at most once per flush.
+    std::unordered_set<NodeId> evaluated;
+
+    while (!_updateQueue.empty()) {
+        if (_updateQueueStale)
+            rebuildUpdateQueue();
+
+        NodeId const nodeId = _updateQueue.top().second;
+        _updateQueue.pop();
+
+        auto it = _pendingUpdates.find(nodeId);
+        if (it == _pendingUpdates.end())
+            continue;
+
+        if (!evaluated.insert(nodeId).second && !_topology.isValid()) {
+            _pendingUpdates.erase(it);
+            continue;
+        }
+
+        PendingUpdate update = std::move(it->second);
+        _pendingUpdates.erase(it);
+
+        deliverInPortData(nodeId, update);
+
+        pushOutPortData(nodeId, std::move(update.outPorts));
+    }
+}
+
+void DataFlowGraphModel::rebuildUpdateQueue()
+{
+    std::vector<QueueEntry> entries;
+    entries.reserve(_pendingUpdates.size());
+
+    for (auto const &p : _pendingUpdates) {
+        entries.emplace_back(_topology.rank(p.first), p.first);
+    }
+
+    _updateQueue = decltype(_updateQueue)(std::greater<QueueEntry>(), std::move(entries));
+    _updateQueueStale = false;
+}
+
+void DataFlowGraphModel::flushInWaves()
+{
+    // Affected part of the graph: everything downstream of a pending node.
+    // Every connection inside it is counted once in the in-degree of its
+    // input node.
+    std::unordered_map<NodeId, std::size_t> inDegree;
+    {
+        std::vector<NodeId> stack;
+        for (auto const &p : _pendingUpdates) {
+            if (inDegree.emplace(p.first, 0).second)
+                stack.push_back(p.first);
+        }
+
+        std::unordered_set<NodeId> visited;
+        while (!stack.empty()) {
+            NodeId const id = stack.back();
+            stack.pop_back();
+
+            if (!visited.insert(id).second)
+                continue;
+
+            for (auto const &cid : allConnectionIds(id)) {
+                if (cid.outNodeId != id)
+                    continue;
+
+                ++inDegree[cid.inNodeId];
+                stack.push_back(cid.inNodeId);
+            }
+        }
+    }
+
+    std::vector<NodeId> wave;
+    for (auto const &d : inDegree) {
+        if (d.second == 0)
+            wave.push_back(d.first);
+    }
+
+    while (!wave.empty()) {
+        evaluateWave(wave);
+
+        // Nodes without pending updates are passed through so that their
+        // consumers are not held back.
+        std::vector<NodeId> next;
+        for (NodeId const id : wave) {
+            for (auto const &cid : allConnectionIds(id)) {
+                if (cid.outNodeId != id)
+                    continue;
+
+                auto it = inDegree.find(cid.inNodeId);
+                if (it != inDegree.end() && --it->second == 0)
+                    next.push_back(cid.inNodeId);
+            }
+        }
+
+        wave = std::move(next);
+    }
+}
+
+namespace {
+
+/// Delivers the inputs of a thread-safe node on a worker thread.
+class NodeEvaluationTask : public QRunnable
+{
+public:
+    NodeEvaluationTask(NodeId const nodeId,
+                       NodeDelegateModel &model,
+                       std::map<PortIndex, QVariant> const &inPorts,
+                       NodeId const cause,
+                       NodeProfiler *profiler,
+                       QSemaphore &done,
+                       std::exception_ptr &error)
+        : _nodeId(nodeId)
+        , _model(model)
+        , _inPorts(inPorts)
+        , _cause(cause)
+        , _profiler(profiler)
+        , _done(done)
+        , _error(error)
+    {
+        // Owned by evaluateWave(), which may also take it back from the pool.
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        qint64 const start = _profiler ? _profiler->now() : 0;
+
+        try {
+            for (auto const &input : _inPorts) {
+                _model.setInData(input.second.value<std::shared_ptr<NodeData>>(), input.first);
+            }
+        } catch (...) {
+            _error = std::current_exception();
+        }
+
+        if (_profiler)
+            _profiler->recordInvocation(_nodeId, _cause, start, _profiler->now() - start);
+
+        _done.release();
+    }
+
+private:
+    NodeId _nodeId;
+
+    NodeDelegateModel &_model;
+
+    std::map<PortIndex, QVariant> const &_inPorts;
+
+    NodeId _cause;
+
+    /// `nullptr` while profiling is disabled.
+    NodeProfiler *_profiler;
+
+    QSemaphore &_done;
+
+    std::exception_ptr &_error;
+};
+
+} // namespace
+
+void DataFlowGraphModel::evaluateWave(std::vector<NodeId> const &wave)
 {
-    std::unordered_set<ConnectionId> const &connected = connections(nodeId,
-                                                                    PortType::Out,
-                                                                    portIndex);
+    std::vector<std::pair<NodeId, PendingUpdate>> concurrent;
+    std::vector<std::pair<NodeId, PendingUpdate>> local;
+
+    for (NodeId const id : wave) {
+        auto it = _pendingUpdates.find(id);
+        if (it == _pendingUpdates.end())
+            continue;
+
+        auto modelIt = _models.find(id);
+        bool const offload = modelIt != _models.end() && !it->second.inPorts.empty()
+                             && modelIt->second->threadSafeCompute();
+
+        (offload ? concurrent : local).emplace_back(id, std::move(it->second));
+        _pendingUpdates.erase(it);
+    }
 
-    QVariant const portDataToPropagate = portData(nodeId, PortType::Out, portIndex, PortRole::Data);
+    QThreadPool *pool = threadPool();
+
+    QSemaphore done;
+    std::vector<std::exception_ptr> errors(concurrent.size());
+    std::vector<std::unique_ptr<NodeEvaluationTask>> tasks;
+    tasks.reserve(concurrent.size());
+
+    for (std::size_t i = 0; i < concurrent.size(); ++i) {
+        auto &model = *_models.at(concurrent[i].first);
+
+        model.cancelCompute();
+
+        tasks.emplace_back(new NodeEvaluationTask(concurrent[i].first,
+                                                  model,
+                                                  concurrent[i].second.inPorts,
+                                                  concurrent[i].second.cause,
+                                                  _profiler.isEnabled() ? &_profiler : nullptr,
+                                                  done,
+                                                  errors[i]));
+
+        pool->start(tasks.back().get());
+    }
 
-    for (auto const &cn : connected) {
-        setPortData(cn.inNodeId, PortType::In, cn.inPortIndex, portDataToPropagate, PortRole::Data);
+    // The model thread takes part in the wave while the pool is busy. The
+    // running tasks refer to the locals of this function, so a failure is
+    // only rethrown once all of them are done.
+    std::exception_ptr localError;
+
+    try {
+        for (auto &job : local) {
+            deliverInPortData(job.first, job.second);
+
+            pushOutPortData(job.first, std::move(job.second.outPorts));
+        }
+    } catch (...) {
+        localError = std::current_exception();
+    }
+
+    // Tasks the pool has not started yet are taken back and run here rather
+    // than waited for.
+    for (auto &task : tasks) {
+        if (pool->tryTake(task.get()))
+            task->run();
+    }
+
+    done.acquire(static_cast<int>(concurrent.size()));
+
+    {
+        QMutexLocker locker(&_concurrentOutPortsMutex);
+
+        for (auto const &out : _concurrentOutPorts) {
+            pendingUpdate(out.first).outPorts.insert(out.second);
+        }
+
+        _concurrentOutPorts.clear();
+    }
+
+    if (localError) {
+        // What the finished nodes produced waits for the next flush.
+        for (auto &job : concurrent) {
+            if (!job.second.outPorts.empty())
+                pendingUpdate(job.first).outPorts.insert(job.second.outPorts.begin(),
+                                                         job.second.outPorts.end());
+        }
+
+        std::rethrow_exception(localError);
+    }
+
+    for (auto &job : concurrent) {
+        for (auto const &input : job.second.inPorts) {
+            Q_EMIT inPortDataWasSet(job.first, PortType::In, input.first);
+        }
+
+        pushOutPortData(job.first, std::move(job.second.outPorts));
+    }
+
+    for (auto const &error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+void DataFlowGraphModel::pushOutPortData(NodeId const nodeId, std::set<PortIndex> outPorts)
+{
+    // Outputs reported by the node while receiving its inputs are pushed
+    // right away instead of waiting for another turn.
+    auto again = _pendingUpdates.find(nodeId);
+    if (again != _pendingUpdates.end() && again->second.inPorts.empty()) {
+        outPorts.insert(again->second.outPorts.begin(), again->second.outPorts.end());
+        _pendingUpdates.erase(again);
     }
+
+    for (PortIndex const portIndex : outPorts) {
+        QVariant const portDataToPropagate = portData(nodeId,
+                                                      PortType::Out,
+                                                      portIndex,
+                                                      PortRole::Data);
+
+        if (_profiler.isEnabled()) {
+            if (auto data = portDataToPropagate.value<std::shared_ptr<NodeData>>())
+                _profiler.recordBytes(nodeId, data->byteSize());
+        }
+
+        for (auto const &cn : connections(nodeId, PortType::Out, portIndex)) {
+            PendingUpdate &update = pendingUpdate(cn.inNodeId);
+            update.inPorts[cn.inPortIndex] = portDataToPropagate;
+            update.cause = nodeId;
+        }
+    }
+}
+
+void DataFlowGraphModel::deliverInPortData(NodeId const nodeId, PendingUpdate const &update)
+{
+    if (update.inPorts.empty())
+        return;
+
+    bool const profiling = _profiler.isEnabled();
+    qint64 const start = profiling ? _profiler.now() : 0;
+
+    for (auto const &input : update.inPorts) {
+        setPortData(nodeId, PortType::In, input.first, input.second, PortRole::Data);
+    }
+
+    if (profiling)
+        _profiler.recordInvocation(nodeId, update.cause, start, _profiler.now() - start);
+}
+
+ExecutionPlan DataFlowGraphModel::compile()
+{
+    ExecutionPlan plan;
+
+    if (!_topology.isValid())
+        return plan;
+
+    plan._model = this;
+    plan._structureVersion = _structureVersion;
+
+    std::vector<NodeId> const order = _topology.sortedNodes();
+
+    plan._steps.reserve(order.size());
+
+    // Output slots are laid out first so that every input can refer to the
+    // slot of its producer.
+    for (NodeId const nodeId : order) {
+        NodeDelegateModel *model = _models.at(nodeId).get();
+
+        ExecutionPlan::Step step;
+        step.nodeId = nodeId;
+        step.model = model;
+        step.firstInput = 0;
+        step.inputCount = 0;
+        step.firstSlot = plan._slots.size();
+        step.slotCount = model->nPorts(PortType::Out);
+
+        plan._stepIndex[nodeId] = plan._steps.size();
+        plan._steps.push_back(step);
+        plan._slots.resize(plan._slots.size() + step.slotCount);
+    }
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        NodeId const nodeId = order[i];
+        ExecutionPlan::Step &step = plan._steps[i];
+
+        step.firstInput = plan._inputs.size();
+
+        for (PortIndex p = 0; p < step.model->nPorts(PortType::In); ++p) {
+            for (auto const &cn : connections(nodeId, PortType::In, p)) {
+                std::size_t const slot = plan.slotIndex(cn.outNodeId, cn.outPortIndex);
+
+                if (slot < plan._slots.size())
+                    plan._inputs.push_back(ExecutionPlan::Input{p, slot});
+            }
+        }
+
+        step.inputCount = plan._inputs.size() - step.firstInput;
+    }
+
+    plan._pinned.assign(plan._slots.size(), false);
+
+    return plan;
+}
+
+QJsonObject DataFlowGraphModel::profileTrace() const
+{
+    return _profiler.chromeTrace([this](NodeId const nodeId) {
+        auto it = _models.find(nodeId);
+
+        if (it == _models.end())
+            return QString::number(nodeId);
+
+        return QStringLiteral("%1 #%2").arg(it->second->caption()).arg(nodeId);
+    });
+}
+
+QThreadPool *DataFlowGraphModel::threadPool() const
+{
+    if (_threadPool)
+        return _threadPool;
+
+    // Kept apart from the global pool, where long-running computations
+    // started with NodeDelegateModel::startCompute() could hold up a wave.
+    if (!_ownThreadPool)
+        _ownThreadPool.reset(new QThreadPool());
+
+    return _ownThreadPool.get();
+}
+
+void DataFlowGraphModel::onOutPortDataUpdated(NodeId const nodeId, PortIndex const portIndex)
+{
+    // Thread-safe nodes report their outputs from a worker thread while a
+    // wave is running; those are picked up once the wave has finished.
+    if (QThread::currentThread() != thread()) {
+        QMutexLocker locker(&_concurrentOutPortsMutex);
+        _concurrentOutPorts.emplace_back(nodeId, portIndex);
+        return;
+    }
+
+    // A running ExecutionPlan reads the outputs itself.
+    if (_planDepth > 0)
+        return;
+
+    pendingUpdate(nodeId).outPorts.insert(portIndex);
+
+    if (_updateDepth == 0)
+        flushUpdates();
 }
 
 void DataFlowGraphModel::propagateEmptyDataTo(NodeId const nodeId, PortIndex const portIndex)
 {
     QVariant emptyData{};
 
-    setPortData(nodeId, PortType::In, portIndex, emptyData, PortRole::Data);
+    scheduleInPortData(nodeId, portIndex, emptyData);
 }
 
 } // namespace QtNodes
@@ -15,8 +15,10 @@
 
 #include <QtCore/QBuffer>
 #include <QtCore/QByteArray>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDataStream>
 #include <QtCore/QDebug>
+#include <QtCore/QEventLoop>
 #include <QtCore/QFile>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
@@ -150,14 +152,20 @@ bool DataFlowGraphicsScene::save() const
     QString fileName = QFileDialog::getSaveFileName(nullptr,
                                                     tr("Open Flow Scene"),
                                                     QDir::homePath(),
-                                                    tr("Flow Scene Files (*.flow)"));
+                                                    tr("Flow Scene Files (*.flow);;"
+                                                       "Binary Flow Scene Files (*.flowb)"));
 
     if (!fileName.isEmpty()) {
-        if (!fileName.endsWith("flow", Qt::CaseInsensitive))
+        bool const binary = fileName.endsWith(".flowb", Qt::CaseInsensitive);
+
+        if (!binary && !fileName.endsWith("flow", Qt::CaseInsensitive))
             fileName += ".flow";
 
         QFile file(fileName);
         if (file.open(QIODevice::WriteOnly)) {
+            if (binary)
+                return _graphModel.saveBinary(file);
+
             file.write(QJsonDocument(_graphModel.save()).toJson());
             return true;
         }
@@ -170,7 +178,7 @@ bool DataFlowGraphicsScene::load()
     QString fileName = QFileDialog::getOpenFileName(nullptr,
                                                     tr("Open Flow Scene"),
                                                     QDir::homePath(),
-                                                    tr("Flow Scene Files (*.flow)"));
+                                                    tr("Flow Scene Files (*.flow *.flowb)"));
 
     if (!QFileInfo::exists(fileName))
         return false;
@@ -182,9 +190,28 @@ bool DataFlowGraphicsScene::load()
 
     clearScene();
 
-    QByteArray const wholeFile = file.readAll();
+    // Graphics objects are built in one pass once the model is complete.
+    suspendUpdates();
+
+    bool ok = false;
+    try {
+        // The format is recognized by its signature, not by the file extension.
+        ok = _graphModel.loadIncrementally(file,
+                                           [this](std::size_t done, std::size_t total) {
+                                               Q_EMIT loadProgress(done, total);
+
+                                               QCoreApplication::processEvents(
+                                                   QEventLoop::ExcludeUserInputEvents);
+                                           });
+    } catch (...) {
+        resumeUpdates();
+        throw;
+    }
 
-    _graphModel.load(QJsonDocument::fromJson(wholeFile).object());
+    resumeUpdates();
+
+    if (!ok)
+        return false;
 
     Q_EMIT sceneLoaded();
 
@@ -0,0 +1,81 @@
+#include "DataTypeRegistry.hpp"
+
+#include <QtCore/QHash>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QVector>
+
+namespace QtNodes {
+
+namespace {
+
+struct Table
+{
+    QReadWriteLock lock;
+
+    QHash<QString, DataTypeHandle> handles;
+
+    /// Index `handle - 1` holds the id.
+    QVector<QString> ids;
+};
+
+Table &table()
+{
+    static Table t;
+
+    return t;
+}
+
+} // namespace
+
+DataTypeHandle DataTypeRegistry::intern(QString const &typeId)
+{
+    if (typeId.isEmpty())
+        return InvalidDataTypeHandle;
+
+    Table &t = table();
+
+    {
+        QReadLocker locker(&t.lock);
+
+        auto it = t.handles.constFind(typeId);
+        if (it != t.handles.constEnd())
+            return it.value();
+    }
+
+    QWriteLocker locker(&t.lock);
+
+    // Another thread may have registered the id in between.
+    auto it = t.handles.constFind(typeId);
+    if (it != t.handles.constEnd())
+        return it.value();
+
+    t.ids.append(typeId);
+
+    DataTypeHandle const handle = static_cast<DataTypeHandle>(t.ids.size());
+    t.handles.insert(typeId, handle);
+
+    return handle;
+}
+
+QString DataTypeRegistry::typeId(DataTypeHandle const handle)
+{
+    Table &t = table();
+
+    QReadLocker locker(&t.lock);
+
+    if (handle == InvalidDataTypeHandle || handle > static_cast<DataTypeHandle>(t.ids.size()))
+        return QString();
+
+    return t.ids.at(static_cast<int>(handle - 1));
+}
+
+std::size_t DataTypeRegistry::size()
+{
+    Table &t = table();
+
+    QReadLocker locker(&t.lock);
+
+    return static_cast<std::size_t>(t.ids.size());
+}
+
+} // namespace QtNodes
@@ -1,6 +1,7 @@
 #include "DefaultConnectionPainter.hpp"
 
 #include "AbstractGraphModel.hpp"
+#include "BasicGraphicsScene.hpp"
 #include "ConnectionGraphicsObject.hpp"
 #include "ConnectionState.hpp"
 #include "Definitions.hpp"
@@ -8,25 +9,44 @@
 #include "StyleCollection.hpp"
 
 #include <QtGui/QIcon>
+#include <QtGui/QLinearGradient>
+#include <QtGui/QPixmap>
+#include <QtGui/QPixmapCache>
 
+#include <map>
 
 namespace QtNodes {
 
-QPainterPath DefaultConnectionPainter::cubicPath(ConnectionGraphicsObject const &connection) const
+namespace {
+
+/**
+ * The converter icon rasterized once per device pixel ratio. The pixmaps live
+ * in QPixmapCache, which Qt clears together with the application; only the
+ * keys are kept here.
+ */
+QPixmap converterPixmap(qreal const devicePixelRatio)
 {
-    QPointF const &in = connection.endPoint(PortType::In);
-    QPointF const &out = connection.endPoint(PortType::Out);
+    static std::map<qreal, QPixmapCache::Key> keys;
+
+    QPixmap pixmap;
+
+    auto it = keys.find(devicePixelRatio);
+
+    if (it != keys.end() && QPixmapCache::find(it->second, &pixmap))
+        return pixmap;
 
-    auto const c1c2 = connection.pointsC1C2();
+    QSize const logicalSize(22, 22);
 
-    // cubic spline
-    QPainterPath cubic(out);
+    pixmap = QIcon(":convert.png").pixmap(logicalSize * devicePixelRatio);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
 
-    cubic.cubicTo(c1c2.first, c1c2.second, in);
+    keys[devicePixelRatio] = QPixmapCache::insert(pixmap);
 
-    return cubic;
+    return pixmap;
 }
 
+} // namespace
+
 void DefaultConnectionPainter::drawSketchLine(QPainter *painter, ConnectionGraphicsObject const &cgo) const
 {
     ConnectionState const &state = cgo.connectionState();
@@ -42,10 +62,8 @@ void DefaultConnectionPainter::drawSketchLine(QPainter *painter, ConnectionGraph
         painter->setPen(pen);
         painter->setBrush(Qt::NoBrush);
 
-        auto cubic = cubicPath(cgo);
-
         // cubic spline
-        painter->drawPath(cubic);
+        painter->drawPath(cgo.cubicPath());
     }
 }
 
@@ -69,8 +87,7 @@ void DefaultConnectionPainter::drawHoveredOrSelected(QPainter *painter, Connecti
         painter->setBrush(Qt::NoBrush);
 
         // cubic spline
-        auto const cubic = cubicPath(cgo);
-        painter->drawPath(cubic);
+        painter->drawPath(cgo.cubicPath());
     }
 }
 
@@ -98,21 +115,18 @@ void DefaultConnectionPainter::drawNormalLine(QPainter *painter, ConnectionGraph
 
         auto const cId = cgo.connectionId();
 
-        auto dataTypeOut = graphModel
-                               .portData(cId.outNodeId,
-                                         PortType::Out,
-                                         cId.outPortIndex,
-                                         PortRole::DataType)
-                               .value<NodeDataType>();
+        DataTypeHandle const dataTypeOut = graphModel.portDataTypeHandle(cId.outNodeId,
+                                                                         PortType::Out,
+                                                                         cId.outPortIndex);
 
-        auto dataTypeIn
-            = graphModel.portData(cId.inNodeId, PortType::In, cId.inPortIndex, PortRole::DataType)
-                  .value<NodeDataType>();
+        DataTypeHandle const dataTypeIn = graphModel.portDataTypeHandle(cId.inNodeId,
+                                                                        PortType::In,
+                                                                        cId.inPortIndex);
 
-        useGradientColor = (dataTypeOut.id != dataTypeIn.id);
+        useGradientColor = (dataTypeOut != dataTypeIn);
 
-        normalColorOut = connectionStyle.normalColor(dataTypeOut.id);
-        normalColorIn = connectionStyle.normalColor(dataTypeIn.id);
+        normalColorOut = connectionStyle.normalColor(dataTypeOut);
+        normalColorIn = connectionStyle.normalColor(dataTypeIn);
         selectedColor = normalColorOut.darker(200);
     }
 
@@ -127,39 +141,42 @@ void DefaultConnectionPainter::drawNormalLine(QPainter *painter, ConnectionGraph
 
     bool const selected = cgo.isSelected();
 
-    auto cubic = cubicPath(cgo);
+    QPainterPath const &cubic = cgo.cubicPath();
     if (useGradientColor) {
-        painter->setBrush(Qt::NoBrush);
-
         QColor cOut = normalColorOut;
-        if (selected)
+        QColor cIn = normalColorIn;
+        if (selected) {
             cOut = cOut.darker(200);
-        p.setColor(cOut);
-        painter->setPen(p);
-
-        unsigned int constexpr segments = 60;
-
-        for (unsigned int i = 0ul; i < segments; ++i) {
-            double ratioPrev = double(i) / segments;
-            double ratio = double(i + 1) / segments;
-
-            if (i == segments / 2) {
-                QColor cIn = normalColorIn;
-                if (selected)
-                    cIn = cIn.darker(200);
+            cIn = cIn.darker(200);
+        }
 
-                p.setColor(cIn);
-                painter->setPen(p);
-            }
-            painter->drawLine(cubic.pointAtPercent(ratioPrev), cubic.pointAtPercent(ratio));
+        QPointF const out = cgo.out();
+        QPointF const in = cgo.in();
+
+        // The color switches halfway along the chord, the whole spline is
+        // stroked at once.
+        if (QLineF(out, in).length() > 1.0) {
+            QLinearGradient gradient(out, in);
+            gradient.setColorAt(0.0, cOut);
+            gradient.setColorAt(0.5, cOut);
+            gradient.setColorAt(0.5 + 1e-3, cIn);
+            gradient.setColorAt(1.0, cIn);
+
+            p.setBrush(gradient);
+        } else {
+            p.setColor(cOut);
         }
 
-        {
-            QIcon icon(":convert.png");
+        painter->setPen(p);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPath(cubic);
 
-            QPixmap pixmap = icon.pixmap(QSize(22, 22));
+        QPixmap const pixmap = converterPixmap(painter->device()->devicePixelRatioF());
+
+        if (!pixmap.isNull()) {
+            QSizeF const size = QSizeF(pixmap.size()) / pixmap.devicePixelRatioF();
             painter->drawPixmap(cubic.pointAtPercent(0.50)
-                                    - QPoint(pixmap.width() / 2, pixmap.height() / 2),
+                                    - QPointF(size.width() / 2, size.height() / 2),
                                 pixmap);
         }
     } else {
@@ -176,8 +193,30 @@ void DefaultConnectionPainter::drawNormalLine(QPainter *painter, ConnectionGraph
     }
 }
 
+void DefaultConnectionPainter::drawStraightLine(QPainter *painter,
+                                                ConnectionGraphicsObject const &cgo) const
+{
+    auto const &connectionStyle = QtNodes::StyleCollection::connectionStyle();
+
+    QPen p(cgo.isSelected() ? connectionStyle.selectedColor() : connectionStyle.normalColor());
+    p.setCosmetic(true);
+
+    if (cgo.connectionState().requiresPort())
+        p.setStyle(Qt::DashLine);
+
+    painter->setPen(p);
+    painter->drawLine(cgo.endPoint(PortType::Out), cgo.endPoint(PortType::In));
+}
+
 void DefaultConnectionPainter::paint(QPainter *painter, ConnectionGraphicsObject const &cgo) const
 {
+    LevelOfDetail const lod = cgo.nodeScene()->levelOfDetail(painter->worldTransform());
+
+    if (lod == LevelOfDetail::Outline) {
+        drawStraightLine(painter, cgo);
+        return;
+    }
+
     drawHoveredOrSelected(painter, cgo);
 
     drawSketchLine(painter, cgo);
@@ -188,6 +227,9 @@ void DefaultConnectionPainter::paint(QPainter *painter, ConnectionGraphicsObject
     debugDrawing(painter, cgo);
 #endif
 
+    if (lod == LevelOfDetail::Simplified)
+        return;
+
     // draw end points
     auto const &connectionStyle = QtNodes::StyleCollection::connectionStyle();
 
@@ -202,7 +244,7 @@ void DefaultConnectionPainter::paint(QPainter *painter, ConnectionGraphicsObject
 
 QPainterPath DefaultConnectionPainter::getPainterStroke(ConnectionGraphicsObject const &connection) const
 {
-    auto cubic = cubicPath(connection);
+    QPainterPath const &cubic = connection.cubicPath();
 
     QPointF const &out = connection.endPoint(PortType::Out);
     QPainterPath result(out);
@@ -241,7 +283,7 @@ void DefaultConnectionPainter::debugDrawing(QPainter *painter, ConnectionGraphic
         painter->drawEllipse(points.second, 3, 3);
 
         painter->setBrush(Qt::NoBrush);
-        painter->drawPath(cubicPath(cgo));
+        painter->drawPath(cgo.cubicPath());
     }
 
     {
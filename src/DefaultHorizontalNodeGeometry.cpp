@@ -36,14 +36,14 @@ QRectF DefaultHorizontalNodeGeometry::boundingRect(NodeId const nodeId) const
 
 QSize DefaultHorizontalNodeGeometry::size(NodeId const nodeId) const
 {
-    return _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    return _graphModel.nodeSize(nodeId);
 }
 
 void DefaultHorizontalNodeGeometry::recomputeSize(NodeId const nodeId) const
 {
     unsigned int height = maxVerticalPortsExtent(nodeId);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         height = std::max(height, static_cast<unsigned int>(w->height()));
     }
 
@@ -65,7 +65,7 @@ void DefaultHorizontalNodeGeometry::recomputeSize(NodeId const nodeId) const
 
     unsigned int width = inPortWidth + outPortWidth + 4 * _portSpasing;
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         width += w->width();
     }
 
@@ -92,7 +92,7 @@ QPointF DefaultHorizontalNodeGeometry::portPosition(NodeId const nodeId,
     totalHeight += step * portIndex;
     totalHeight += step / 2.0;
 
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     switch (portType) {
     case PortType::In: {
@@ -126,7 +126,7 @@ QPointF DefaultHorizontalNodeGeometry::portTextPosition(NodeId const nodeId,
 
     p.setY(p.y() + rect.height() / 4.0);
 
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     switch (portType) {
     case PortType::In:
@@ -146,28 +146,23 @@ QPointF DefaultHorizontalNodeGeometry::portTextPosition(NodeId const nodeId,
 
 QRectF DefaultHorizontalNodeGeometry::captionRect(NodeId const nodeId) const
 {
-    if (!_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible))
-        return QRect();
-
-    QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
-
-    return _boldFontMetrics.boundingRect(name);
+    return nodeCache(nodeId).captionRect;
 }
 
 QPointF DefaultHorizontalNodeGeometry::captionPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
     return QPointF(0.5 * (size.width() - captionRect(nodeId).width()),
                    0.5 * _portSpasing + captionRect(nodeId).height());
 }
 
 QPointF DefaultHorizontalNodeGeometry::widgetPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     unsigned int captionHeight = captionRect(nodeId).height();
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         // If the widget wants to use as much vertical space as possible,
         // place it immediately after the caption.
         if (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
@@ -183,7 +178,7 @@ QPointF DefaultHorizontalNodeGeometry::widgetPosition(NodeId const nodeId) const
 
 QRect DefaultHorizontalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     unsigned int rectSize = 7;
 
@@ -194,23 +189,22 @@ QRectF DefaultHorizontalNodeGeometry::portTextRect(NodeId const nodeId,
                                                    PortType const portType,
                                                    PortIndex const portIndex) const
 {
-    QString s;
-    if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-        s = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-    } else {
-        auto portData = _graphModel.portData(nodeId, portType, portIndex, PortRole::DataType);
+    if (portType == PortType::None)
+        return QRectF();
 
-        s = portData.value<NodeDataType>().name;
-    }
+    auto const &rects = nodeCache(nodeId).portTextRects[static_cast<int>(portType)];
+
+    if (portIndex >= rects.size())
+        return QRectF();
 
-    return _fontMetrics.boundingRect(s);
+    return rects[portIndex];
 }
 
 unsigned int DefaultHorizontalNodeGeometry::maxVerticalPortsExtent(NodeId const nodeId) const
 {
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
+    PortCount nInPorts = _graphModel.portCount(nodeId, PortType::In);
 
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    PortCount nOutPorts = _graphModel.portCount(nodeId, PortType::Out);
 
     unsigned int maxNumOfEntries = std::max(nInPorts, nOutPorts);
     unsigned int step = _portSize + _portSpasing;
@@ -221,36 +215,82 @@ unsigned int DefaultHorizontalNodeGeometry::maxVerticalPortsExtent(NodeId const
 unsigned int DefaultHorizontalNodeGeometry::maxPortsTextAdvance(NodeId const nodeId,
                                                                 PortType const portType) const
 {
-    unsigned int width = 0;
+    if (portType == PortType::None)
+        return 0;
 
-    size_t const n = _graphModel
-                         .nodeData(nodeId,
-                                   (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                               : NodeRole::InPortCount)
-                         .toUInt();
+    return nodeCache(nodeId).maxPortsTextAdvance[static_cast<int>(portType)];
+}
 
-    for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
-        QString name;
+void DefaultHorizontalNodeGeometry::invalidate(NodeId const nodeId)
+{
+    _nodeCache.erase(nodeId);
+}
 
-        if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-            name = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-        } else {
-            NodeDataType portData = _graphModel.portData<NodeDataType>(nodeId,
-                                                                       portType,
-                                                                       portIndex,
-                                                                       PortRole::DataType);
+void DefaultHorizontalNodeGeometry::invalidateAll()
+{
+    _nodeCache.clear();
 
-            name = portData.name;
-        }
+    QFont f;
+    _fontMetrics = QFontMetrics(f);
+
+    f.setBold(true);
+    _boldFontMetrics = QFontMetrics(f);
+
+    _portSize = _fontMetrics.height();
+}
+
+DefaultHorizontalNodeGeometry::NodeCache const &DefaultHorizontalNodeGeometry::nodeCache(
+    NodeId const nodeId) const
+{
+    unsigned int const nInPorts = _graphModel.portCount(nodeId, PortType::In);
+    unsigned int const nOutPorts = _graphModel.portCount(nodeId, PortType::Out);
+
+    auto it = _nodeCache.find(nodeId);
+
+    // Ports inserted or removed without a node update also force a rebuild.
+    if (it != _nodeCache.end() && it->second.portTextRects[0].size() == nInPorts
+        && it->second.portTextRects[1].size() == nOutPorts)
+        return it->second;
+
+    NodeCache &cache = _nodeCache[nodeId];
+
+    cache.captionRect = QRectF();
+
+    if (_graphModel.nodeCaptionVisible(nodeId))
+        cache.captionRect = _boldFontMetrics.boundingRect(_graphModel.nodeCaption(nodeId));
+
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        int const side = static_cast<int>(portType);
+        unsigned int const n = (portType == PortType::In) ? nInPorts : nOutPorts;
+
+        auto &rects = cache.portTextRects[side];
+        rects.clear();
+        rects.reserve(n);
+
+        unsigned int width = 0;
+
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+            QString name;
+
+            if (_graphModel.portCaptionVisible(nodeId, portType, portIndex)) {
+                name = _graphModel.portCaption(nodeId, portType, portIndex);
+            } else {
+                name = _graphModel.portDataType(nodeId, portType, portIndex).name;
+            }
+
+            rects.push_back(_fontMetrics.boundingRect(name));
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
+            width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
 #else
-        width = std::max(unsigned(_fontMetrics.width(name)), width);
+            width = std::max(unsigned(_fontMetrics.width(name)), width);
 #endif
+        }
+
+        cache.maxPortsTextAdvance[side] = width;
     }
 
-    return width;
+    return cache;
 }
 
 } // namespace QtNodes
@@ -12,6 +12,7 @@
 #include "StyleCollection.hpp"
 
 #include <QtCore/QMargins>
+#include <QtGui/QFontMetrics>
 
 #include <cmath>
 
@@ -23,8 +24,20 @@ void DefaultNodePainter::paint(QPainter *painter, NodeGraphicsObject &ngo) const
     //AbstractNodeGeometry & geometry = ngo.nodeScene()->nodeGeometry();
     //geometry.recomputeSizeIfFontChanged(painter->font());
 
+    LevelOfDetail const lod = ngo.nodeScene()->levelOfDetail(painter->worldTransform());
+
+    if (lod == LevelOfDetail::Outline) {
+        drawNodeOutline(painter, ngo);
+        return;
+    }
+
     drawNodeRect(painter, ngo);
 
+    if (lod == LevelOfDetail::Simplified) {
+        drawNodeCaption(painter, ngo);
+        return;
+    }
+
     drawConnectionPoints(painter, ngo);
 
     drawFilledConnectionPoints(painter, ngo);
@@ -38,6 +51,9 @@ void DefaultNodePainter::paint(QPainter *painter, NodeGraphicsObject &ngo) const
     drawResizeRect(painter, ngo);
 
     drawValidationIcon(painter, ngo);
+
+    if (_profilerOverlay)
+        drawProfilerOverlay(painter, ngo);
 }
 
 void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const
@@ -50,9 +66,7 @@ void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo
 
     QSize size = geometry.size(nodeId);
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     QVariant var = model.nodeData(nodeId, NodeRole::ValidationState);
 
@@ -99,14 +113,30 @@ void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo
     painter->drawRoundedRect(boundary, radius, radius);
 }
 
+void DefaultNodePainter::drawNodeOutline(QPainter *painter, NodeGraphicsObject &ngo) const
+{
+    AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
+
+    QSize size = geometry.size(ngo.nodeId());
+
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
+
+    QPen p(ngo.isSelected() ? nodeStyle.SelectedBoundaryColor : nodeStyle.NormalBoundaryColor);
+    p.setCosmetic(true);
+
+    painter->setPen(p);
+    painter->setBrush(nodeStyle.GradientColor1);
+
+    painter->drawRect(QRectF(0, 0, size.width(), size.height()));
+}
+
 void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObject &ngo) const
 {
     AbstractGraphModel &model = ngo.graphModel();
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     auto const &connectionStyle = StyleCollection::connectionStyle();
 
@@ -114,16 +144,11 @@ void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObj
     auto reducedDiameter = diameter * 0.6;
 
     for (PortType portType : {PortType::Out, PortType::In}) {
-        auto portCountRole = (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                         : NodeRole::InPortCount;
-        size_t const n = model.nodeData(nodeId, portCountRole).toUInt();
+        size_t const n = model.portCount(nodeId, portType);
 
         for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
             QPointF p = geometry.portPosition(nodeId, portType, portIndex);
 
-            auto const &dataType = model.portData(nodeId, portType, portIndex, PortRole::DataType)
-                                       .value<NodeDataType>();
-
             double r = 1.0;
 
             NodeState const &state = ngo.nodeState();
@@ -155,7 +180,10 @@ void DefaultNodePainter::drawConnectionPoints(QPainter *painter, NodeGraphicsObj
             }
 
             if (connectionStyle.useDataDefinedColors()) {
-                painter->setBrush(connectionStyle.normalColor(dataType.id));
+                DataTypeHandle const dataType = model.portDataTypeHandle(nodeId,
+                                                                         portType,
+                                                                         portIndex);
+                painter->setBrush(connectionStyle.normalColor(dataType));
             } else {
                 painter->setBrush(nodeStyle.ConnectionPointColor);
             }
@@ -175,17 +203,12 @@ void DefaultNodePainter::drawFilledConnectionPoints(QPainter *painter, NodeGraph
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     auto diameter = nodeStyle.ConnectionPointDiameter;
 
     for (PortType portType : {PortType::Out, PortType::In}) {
-        size_t const n = model
-                             .nodeData(nodeId,
-                                       (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                                   : NodeRole::InPortCount)
-                             .toUInt();
+        size_t const n = model.portCount(nodeId, portType);
 
         for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
             QPointF p = geometry.portPosition(nodeId, portType, portIndex);
@@ -193,13 +216,12 @@ void DefaultNodePainter::drawFilledConnectionPoints(QPainter *painter, NodeGraph
             auto const &connected = model.connections(nodeId, portType, portIndex);
 
             if (!connected.empty()) {
-                auto const &dataType = model
-                                           .portData(nodeId, portType, portIndex, PortRole::DataType)
-                                           .value<NodeDataType>();
-
                 auto const &connectionStyle = StyleCollection::connectionStyle();
                 if (connectionStyle.useDataDefinedColors()) {
-                    QColor const c = connectionStyle.normalColor(dataType.id);
+                    DataTypeHandle const dataType = model.portDataTypeHandle(nodeId,
+                                                                             portType,
+                                                                             portIndex);
+                    QColor const c = connectionStyle.normalColor(dataType);
                     painter->setPen(c);
                     painter->setBrush(c);
                 } else {
@@ -219,18 +241,17 @@ void DefaultNodePainter::drawNodeCaption(QPainter *painter, NodeGraphicsObject &
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    if (!model.nodeData(nodeId, NodeRole::CaptionVisible).toBool())
+    if (!model.nodeCaptionVisible(nodeId))
         return;
 
-    QString const name = model.nodeData(nodeId, NodeRole::Caption).toString();
+    QString const name = model.nodeCaption(nodeId);
 
     QFont f = painter->font();
     f.setBold(true);
 
     QPointF position = geometry.captionPosition(nodeId);
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     painter->setFont(f);
     painter->setPen(nodeStyle.FontColor);
@@ -246,14 +267,10 @@ void DefaultNodePainter::drawEntryLabels(QPainter *painter, NodeGraphicsObject &
     NodeId const nodeId = ngo.nodeId();
     AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     for (PortType portType : {PortType::Out, PortType::In}) {
-        unsigned int n = model.nodeData<unsigned int>(nodeId,
-                                                      (portType == PortType::Out)
-                                                          ? NodeRole::OutPortCount
-                                                          : NodeRole::InPortCount);
+        unsigned int n = model.portCount(nodeId, portType);
 
         for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
             auto const &connected = model.connections(nodeId, portType, portIndex);
@@ -267,12 +284,10 @@ void DefaultNodePainter::drawEntryLabels(QPainter *painter, NodeGraphicsObject &
 
             QString s;
 
-            if (model.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-                s = model.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
+            if (model.portCaptionVisible(nodeId, portType, portIndex)) {
+                s = model.portCaption(nodeId, portType, portIndex);
             } else {
-                auto portData = model.portData(nodeId, portType, portIndex, PortRole::DataType);
-
-                s = portData.value<NodeDataType>().name;
+                s = model.portDataType(nodeId, portType, portIndex).name;
             }
 
             painter->drawText(p, s);
@@ -353,8 +368,7 @@ void DefaultNodePainter::drawValidationIcon(QPainter *painter, NodeGraphicsObjec
     if (state._state == NodeValidationState::State::Valid)
         return;
 
-    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
-    NodeStyle nodeStyle(json.object());
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
 
     QSize size = geometry.size(nodeId);
 
@@ -386,4 +400,53 @@ void DefaultNodePainter::drawValidationIcon(QPainter *painter, NodeGraphicsObjec
     painter->restore();
 }
 
+void DefaultNodePainter::drawProfilerOverlay(QPainter *painter, NodeGraphicsObject &ngo) const
+{
+    auto *dfModel = dynamic_cast<DataFlowGraphModel *>(&ngo.graphModel());
+    if (!dfModel)
+        return;
+
+    NodeProfiler const &profiler = dfModel->profiler();
+
+    NodeId const nodeId = ngo.nodeId();
+
+    NodeProfiler::NodeStats const stats = profiler.stats(nodeId);
+    if (stats.invocations == 0)
+        return;
+
+    qint64 const hottest = profiler.maxTotalNs();
+    qreal const heat = hottest > 0 ? qreal(stats.totalNs) / hottest : 0.0;
+
+    AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
+
+    QSize const size = geometry.size(nodeId);
+
+    NodeStyle const &nodeStyle = ngo.nodeStyle();
+
+    painter->save();
+
+    // Green for the cheapest nodes up to red for the hottest one.
+    QColor const color = QColor::fromHsvF((1.0 - heat) / 3.0, 0.9, 0.9);
+
+    QRectF const bar(0.0, 0.0, size.width() * heat, 3.0);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(color);
+    painter->drawRect(bar);
+
+    QString const text = QStringLiteral("%1 ms / %2")
+                             .arg(stats.totalNs / 1e6, 0, 'f', 2)
+                             .arg(stats.invocations);
+
+    QFont font = painter->font();
+    if (font.pointSizeF() > 0.0)
+        font.setPointSizeF(font.pointSizeF() * 0.8);
+    painter->setFont(font);
+    painter->setPen(nodeStyle.FontColorFaded);
+
+    QRectF const textRect(0.0, bar.height(), size.width() - 4.0, QFontMetrics(font).height());
+    painter->drawText(textRect, Qt::AlignRight | Qt::AlignTop, text);
+
+    painter->restore();
+}
+
 } // namespace QtNodes
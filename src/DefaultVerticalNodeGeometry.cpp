@@ -37,14 +37,14 @@ QRectF DefaultVerticalNodeGeometry::boundingRect(NodeId const nodeId) const
 
 QSize DefaultVerticalNodeGeometry::size(NodeId const nodeId) const
 {
-    return _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    return _graphModel.nodeSize(nodeId);
 }
 
 void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
 {
     unsigned int height = _portSpasing; // maxHorizontalPortsExtent(nodeId);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         height = std::max(height, static_cast<unsigned int>(w->height()));
     }
 
@@ -55,8 +55,8 @@ void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
     height += _portSpasing;
     height += _portSpasing;
 
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    PortCount nInPorts = _graphModel.portCount(nodeId, PortType::In);
+    PortCount nOutPorts = _graphModel.portCount(nodeId, PortType::Out);
 
     // Adding double step (top and bottom) to reserve space for port captions.
 
@@ -76,7 +76,7 @@ void DefaultVerticalNodeGeometry::recomputeSize(NodeId const nodeId) const
 
     unsigned int width = std::max(totalInPortsWidth, totalOutPortsWidth);
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         width = std::max(width, static_cast<unsigned int>(w->width()));
     }
 
@@ -96,13 +96,13 @@ QPointF DefaultVerticalNodeGeometry::portPosition(NodeId const nodeId,
 {
     QPointF result;
 
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     switch (portType) {
     case PortType::In: {
         unsigned int inPortWidth = maxPortsTextAdvance(nodeId, PortType::In) + _portSpasing;
 
-        PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
+        PortCount nInPorts = _graphModel.portCount(nodeId, PortType::In);
 
         double x = (size.width() - (nInPorts - 1) * inPortWidth) / 2.0 + portIndex * inPortWidth;
 
@@ -115,7 +115,7 @@ QPointF DefaultVerticalNodeGeometry::portPosition(NodeId const nodeId,
 
     case PortType::Out: {
         unsigned int outPortWidth = maxPortsTextAdvance(nodeId, PortType::Out) + _portSpasing;
-        PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+        PortCount nOutPorts = _graphModel.portCount(nodeId, PortType::Out);
 
         double x = (size.width() - (nOutPorts - 1) * outPortWidth) / 2.0 + portIndex * outPortWidth;
 
@@ -143,7 +143,7 @@ QPointF DefaultVerticalNodeGeometry::portTextPosition(NodeId const nodeId,
 
     p.setX(p.x() - rect.width() / 2.0);
 
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     switch (portType) {
     case PortType::In:
@@ -163,17 +163,12 @@ QPointF DefaultVerticalNodeGeometry::portTextPosition(NodeId const nodeId,
 
 QRectF DefaultVerticalNodeGeometry::captionRect(NodeId const nodeId) const
 {
-    if (!_graphModel.nodeData<bool>(nodeId, NodeRole::CaptionVisible))
-        return QRect();
-
-    QString name = _graphModel.nodeData<QString>(nodeId, NodeRole::Caption);
-
-    return _boldFontMetrics.boundingRect(name);
+    return nodeCache(nodeId).captionRect;
 }
 
 QPointF DefaultVerticalNodeGeometry::captionPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     unsigned int step = portCaptionsHeight(nodeId, PortType::In);
     step += _portSpasing;
@@ -185,11 +180,11 @@ QPointF DefaultVerticalNodeGeometry::captionPosition(NodeId const nodeId) const
 
 QPointF DefaultVerticalNodeGeometry::widgetPosition(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     unsigned int captionHeight = captionRect(nodeId).height();
 
-    if (auto w = _graphModel.nodeData<QWidget *>(nodeId, NodeRole::Widget)) {
+    if (auto w = _graphModel.nodeWidget(nodeId)) {
         // If the widget wants to use as much vertical space as possible,
         // place it immediately after the caption.
         if (w->sizePolicy().verticalPolicy() & QSizePolicy::ExpandFlag) {
@@ -204,7 +199,7 @@ QPointF DefaultVerticalNodeGeometry::widgetPosition(NodeId const nodeId) const
 
 QRect DefaultVerticalNodeGeometry::resizeHandleRect(NodeId const nodeId) const
 {
-    QSize size = _graphModel.nodeData<QSize>(nodeId, NodeRole::Size);
+    QSize size = _graphModel.nodeSize(nodeId);
 
     unsigned int rectSize = 7;
 
@@ -215,23 +210,22 @@ QRectF DefaultVerticalNodeGeometry::portTextRect(NodeId const nodeId,
                                                  PortType const portType,
                                                  PortIndex const portIndex) const
 {
-    QString s;
-    if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-        s = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-    } else {
-        auto portData = _graphModel.portData(nodeId, portType, portIndex, PortRole::DataType);
+    if (portType == PortType::None)
+        return QRectF();
 
-        s = portData.value<NodeDataType>().name;
-    }
+    auto const &rects = nodeCache(nodeId).portTextRects[static_cast<int>(portType)];
+
+    if (portIndex >= rects.size())
+        return QRectF();
 
-    return _fontMetrics.boundingRect(s);
+    return rects[portIndex];
 }
 
 unsigned int DefaultVerticalNodeGeometry::maxHorizontalPortsExtent(NodeId const nodeId) const
 {
-    PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
+    PortCount nInPorts = _graphModel.portCount(nodeId, PortType::In);
 
-    PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
+    PortCount nOutPorts = _graphModel.portCount(nodeId, PortType::Out);
 
     unsigned int maxNumOfEntries = std::max(nInPorts, nOutPorts);
     unsigned int step = _portSize + _portSpasing;
@@ -242,71 +236,94 @@ unsigned int DefaultVerticalNodeGeometry::maxHorizontalPortsExtent(NodeId const
 unsigned int DefaultVerticalNodeGeometry::maxPortsTextAdvance(NodeId const nodeId,
                                                               PortType const portType) const
 {
-    unsigned int width = 0;
+    if (portType == PortType::None)
+        return 0;
 
-    size_t const n = _graphModel
-                         .nodeData(nodeId,
-                                   (portType == PortType::Out) ? NodeRole::OutPortCount
-                                                               : NodeRole::InPortCount)
-                         .toUInt();
+    return nodeCache(nodeId).maxPortsTextAdvance[static_cast<int>(portType)];
+}
 
-    for (PortIndex portIndex = 0ul; portIndex < n; ++portIndex) {
-        QString name;
+unsigned int DefaultVerticalNodeGeometry::portCaptionsHeight(NodeId const nodeId,
+                                                             PortType const portType) const
+{
+    if (portType == PortType::None)
+        return 0;
 
-        if (_graphModel.portData<bool>(nodeId, portType, portIndex, PortRole::CaptionVisible)) {
-            name = _graphModel.portData<QString>(nodeId, portType, portIndex, PortRole::Caption);
-        } else {
-            NodeDataType portData = _graphModel.portData<NodeDataType>(nodeId,
-                                                                       portType,
-                                                                       portIndex,
-                                                                       PortRole::DataType);
+    return nodeCache(nodeId).anyCaptionVisible[static_cast<int>(portType)] ? _portSpasing : 0;
+}
 
-            name = portData.name;
-        }
+void DefaultVerticalNodeGeometry::invalidate(NodeId const nodeId)
+{
+    _nodeCache.erase(nodeId);
+}
 
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
-#else
-        width = std::max(unsigned(_fontMetrics.width(name)), width);
-#endif
-    }
+void DefaultVerticalNodeGeometry::invalidateAll()
+{
+    _nodeCache.clear();
+
+    QFont f;
+    _fontMetrics = QFontMetrics(f);
 
-    return width;
+    f.setBold(true);
+    _boldFontMetrics = QFontMetrics(f);
+
+    _portSize = _fontMetrics.height();
 }
 
-unsigned int DefaultVerticalNodeGeometry::portCaptionsHeight(NodeId const nodeId,
-                                                             PortType const portType) const
+DefaultVerticalNodeGeometry::NodeCache const &DefaultVerticalNodeGeometry::nodeCache(
+    NodeId const nodeId) const
 {
-    unsigned int h = 0;
+    unsigned int const nInPorts = _graphModel.portCount(nodeId, PortType::In);
+    unsigned int const nOutPorts = _graphModel.portCount(nodeId, PortType::Out);
 
-    switch (portType) {
-    case PortType::In: {
-        PortCount nInPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::InPortCount);
-        for (PortIndex i = 0; i < nInPorts; ++i) {
-            if (_graphModel.portData<bool>(nodeId, PortType::In, i, PortRole::CaptionVisible)) {
-                h += _portSpasing;
-                break;
-            }
-        }
-        break;
-    }
+    auto it = _nodeCache.find(nodeId);
 
-    case PortType::Out: {
-        PortCount nOutPorts = _graphModel.nodeData<PortCount>(nodeId, NodeRole::OutPortCount);
-        for (PortIndex i = 0; i < nOutPorts; ++i) {
-            if (_graphModel.portData<bool>(nodeId, PortType::Out, i, PortRole::CaptionVisible)) {
-                h += _portSpasing;
-                break;
+    // Ports inserted or removed without a node update also force a rebuild.
+    if (it != _nodeCache.end() && it->second.portTextRects[0].size() == nInPorts
+        && it->second.portTextRects[1].size() == nOutPorts)
+        return it->second;
+
+    NodeCache &cache = _nodeCache[nodeId];
+
+    cache.captionRect = QRectF();
+
+    if (_graphModel.nodeCaptionVisible(nodeId))
+        cache.captionRect = _boldFontMetrics.boundingRect(_graphModel.nodeCaption(nodeId));
+
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        int const side = static_cast<int>(portType);
+        unsigned int const n = (portType == PortType::In) ? nInPorts : nOutPorts;
+
+        auto &rects = cache.portTextRects[side];
+        rects.clear();
+        rects.reserve(n);
+
+        cache.anyCaptionVisible[side] = false;
+
+        unsigned int width = 0;
+
+        for (PortIndex portIndex = 0; portIndex < n; ++portIndex) {
+            QString name;
+
+            if (_graphModel.portCaptionVisible(nodeId, portType, portIndex)) {
+                name = _graphModel.portCaption(nodeId, portType, portIndex);
+                cache.anyCaptionVisible[side] = true;
+            } else {
+                name = _graphModel.portDataType(nodeId, portType, portIndex).name;
             }
+
+            rects.push_back(_fontMetrics.boundingRect(name));
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+            width = std::max(unsigned(_fontMetrics.horizontalAdvance(name)), width);
+#else
+            width = std::max(unsigned(_fontMetrics.width(name)), width);
+#endif
         }
-        break;
-    }
 
-    default:
-        break;
+        cache.maxPortsTextAdvance[side] = width;
     }
 
-    return h;
+    return cache;
 }
 
 } // namespace QtNodes
@@ -0,0 +1,103 @@
+#include "ExecutionPlan.hpp"
+
+#include "DataFlowGraphModel.hpp"
+#include "NodeDelegateModel.hpp"
+
+#include <algorithm>
+
+namespace QtNodes {
+
+bool ExecutionPlan::isValid() const
+{
+    return _model && _model->structureVersion() == _structureVersion;
+}
+
+void ExecutionPlan::setSourceData(NodeId const nodeId,
+                                  PortIndex const portIndex,
+                                  std::shared_ptr<NodeData> data)
+{
+    std::size_t const slot = slotIndex(nodeId, portIndex);
+
+    if (slot == _slots.size())
+        return;
+
+    _slots[slot] = std::move(data);
+    _pinned[slot] = true;
+}
+
+void ExecutionPlan::clearSourceData()
+{
+    std::fill(_pinned.begin(), _pinned.end(), false);
+}
+
+bool ExecutionPlan::run()
+{
+    _pendingNodeId = InvalidNodeId;
+
+    if (!isValid())
+        return false;
+
+    // Outputs reported while the plan runs are already picked up by it.
+    ++_model->_planDepth;
+
+    try {
+        for (Step const &step : _steps) {
+            if (step.inputCount > 0) {
+                ComputeTask const previous = step.model->currentCompute();
+
+                for (std::size_t i = step.firstInput; i < step.firstInput + step.inputCount; ++i)
+                    step.model->setInData(_slots[_inputs[i].slot], _inputs[i].portIndex);
+
+                // A computation still running for the previous inputs is stale
+                // now, unless the node superseded it with a new one.
+                if (previous.isValid() && step.model->currentCompute() == previous)
+                    step.model->cancelCompute();
+
+                // outData() would still return the previous result.
+                if (step.model->currentCompute().isValid()) {
+                    _pendingNodeId = step.nodeId;
+                    break;
+                }
+            }
+
+            for (std::size_t i = 0; i < step.slotCount; ++i) {
+                std::size_t const slot = step.firstSlot + i;
+
+                if (!_pinned[slot])
+                    _slots[slot] = step.model->outData(static_cast<PortIndex>(i));
+            }
+        }
+    } catch (...) {
+        --_model->_planDepth;
+        throw;
+    }
+
+    --_model->_planDepth;
+
+    return _pendingNodeId == InvalidNodeId;
+}
+
+std::shared_ptr<NodeData> ExecutionPlan::outData(NodeId const nodeId,
+                                                 PortIndex const portIndex) const
+{
+    std::size_t const slot = slotIndex(nodeId, portIndex);
+
+    return slot < _slots.size() ? _slots[slot] : nullptr;
+}
+
+std::size_t ExecutionPlan::slotIndex(NodeId const nodeId, PortIndex const portIndex) const
+{
+    auto it = _stepIndex.find(nodeId);
+
+    if (it == _stepIndex.end())
+        return _slots.size();
+
+    Step const &step = _steps[it->second];
+
+    if (portIndex >= step.slotCount)
+        return _slots.size();
+
+    return step.firstSlot + portIndex;
+}
+
+} // namespace QtNodes
@@ -6,6 +6,7 @@
 #include "NodeGraphicsObject.hpp"
 #include "StyleCollection.hpp"
 #include "UndoCommands.hpp"
+#include "UndoHistory.hpp"
 
 #include <QtWidgets/QGraphicsScene>
 
@@ -22,11 +23,14 @@
 #include <QtWidgets>
 
 #include <cmath>
+#include <unordered_set>
 
 using QtNodes::BasicGraphicsScene;
+using QtNodes::ConnectionId;
 using QtNodes::DataFlowGraphModel;
 using QtNodes::GraphicsView;
 using QtNodes::NodeGraphicsObject;
+using QtNodes::NodeId;
 
 GraphicsView::GraphicsView(QWidget *parent)
     : QGraphicsView(parent)
@@ -57,6 +61,11 @@ GraphicsView::GraphicsView(QWidget *parent)
     // re-calculation when expanding the all QGraphicsItems common rect.
     int maxSize = 32767;
     setSceneRect(-maxSize, -maxSize, (maxSize * 2), (maxSize * 2));
+
+    connect(this, &GraphicsView::scaleChanged, this, [this]() {
+        if (nodeScene())
+            nodeScene()->updateNodeWidgetVisibility();
+    });
 }
 
 GraphicsView::GraphicsView(BasicGraphicsScene *scene, QWidget *parent)
@@ -157,13 +166,15 @@ void GraphicsView::setScene(BasicGraphicsScene *scene)
         addAction(_pasteAction);
     }
 
-    auto undoAction = scene->undoStack().createUndoAction(this, tr("&Undo"));
+    auto undoAction = scene->undoHistory().createUndoAction(this, tr("&Undo"));
     undoAction->setShortcuts(QKeySequence::Undo);
     addAction(undoAction);
 
     auto redoAction = scene->undoStack().createRedoAction(this, tr("&Redo"));
     redoAction->setShortcuts(QKeySequence::Redo);
     addAction(redoAction);
+
+    scene->updateNodeWidgetVisibility();
 }
 
 void GraphicsView::centerScene()
@@ -332,7 +343,10 @@ void GraphicsView::keyPressEvent(QKeyEvent *event)
 {
     switch (event->key()) {
     case Qt::Key_Shift:
-        setDragMode(QGraphicsView::RubberBandDrag);
+        // Rubber-band selection is done here through the spatial index;
+        // QGraphicsView would test every item of the scene on each move.
+        setDragMode(QGraphicsView::NoDrag);
+        _rubberBandSelection = true;
         break;
 
     default:
@@ -347,6 +361,10 @@ void GraphicsView::keyReleaseEvent(QKeyEvent *event)
     switch (event->key()) {
     case Qt::Key_Shift:
         setDragMode(QGraphicsView::ScrollHandDrag);
+        _rubberBandSelection = false;
+
+        if (_rubberBand)
+            _rubberBand->hide();
         break;
 
     default:
@@ -360,6 +378,15 @@ void GraphicsView::mousePressEvent(QMouseEvent *event)
     QGraphicsView::mousePressEvent(event);
     if (event->button() == Qt::LeftButton) {
         _clickPos = mapToScene(event->pos());
+
+        if (_rubberBandSelection && scene() && scene()->mouseGrabberItem() == nullptr) {
+            if (!_rubberBand)
+                _rubberBand = new QRubberBand(QRubberBand::Rectangle, viewport());
+
+            _rubberBandOrigin = event->pos();
+            _rubberBand->setGeometry(QRect(_rubberBandOrigin, QSize()));
+            _rubberBand->show();
+        }
     }
 }
 
@@ -370,6 +397,12 @@ void GraphicsView::mouseMoveEvent(QMouseEvent *event)
     if (!scene())
         return;
 
+    if (_rubberBand && _rubberBand->isVisible()) {
+        _rubberBand->setGeometry(QRect(_rubberBandOrigin, event->pos()).normalized());
+        updateRubberBandSelection();
+        return;
+    }
+
     if (scene()->mouseGrabberItem() == nullptr && event->buttons() == Qt::LeftButton) {
         // Make sure shift is not being pressed
         if ((event->modifiers() & Qt::ShiftModifier) == 0) {
@@ -379,6 +412,56 @@ void GraphicsView::mouseMoveEvent(QMouseEvent *event)
     }
 }
 
+void GraphicsView::mouseReleaseEvent(QMouseEvent *event)
+{
+    QGraphicsView::mouseReleaseEvent(event);
+
+    if (event->button() == Qt::LeftButton && _rubberBand)
+        _rubberBand->hide();
+}
+
+void GraphicsView::updateRubberBandSelection()
+{
+    BasicGraphicsScene *scene = nodeScene();
+
+    if (!scene)
+        return;
+
+    QPainterPath selectionArea;
+    selectionArea.addPolygon(mapToScene(_rubberBand->geometry()));
+    selectionArea.closeSubpath();
+
+    QRectF const area = selectionArea.boundingRect();
+
+    std::unordered_set<QGraphicsItem *> selected;
+
+    auto collect = [&](QGraphicsItem *item) {
+        if (item && item->isVisible() && (item->flags() & QGraphicsItem::ItemIsSelectable)
+            && item->collidesWithPath(item->mapFromScene(selectionArea),
+                                      rubberBandSelectionMode())) {
+            selected.insert(item);
+        }
+    };
+
+    for (NodeId const nodeId : scene->spatialIndex().nodesIn(area)) {
+        collect(scene->nodeGraphicsObject(nodeId));
+    }
+
+    for (ConnectionId const &connectionId : scene->spatialIndex().connectionsIn(area)) {
+        collect(scene->connectionGraphicsObject(connectionId));
+    }
+
+    // Only the items whose state changes are touched.
+    for (QGraphicsItem *item : scene->selectedItems()) {
+        if (selected.count(item) == 0)
+            item->setSelected(false);
+    }
+
+    for (QGraphicsItem *item : selected) {
+        item->setSelected(true);
+    }
+}
+
 void GraphicsView::drawBackground(QPainter *painter, const QRectF &r)
 {
     QGraphicsView::drawBackground(painter, r);
@@ -420,6 +503,113 @@ void GraphicsView::drawBackground(QPainter *painter, const QRectF &r)
     drawGrid(150);
 }
 
+void GraphicsView::drawForeground(QPainter *painter, const QRectF &r)
+{
+    QGraphicsView::drawForeground(painter, r);
+
+    if (!_diagnosticsOverlay || !nodeScene())
+        return;
+
+    auto const &frame = nodeScene()->renderDiagnostics().lastFrame();
+
+    auto ms = [](qint64 ns) { return QString::number(ns / 1e6, 'f', 2); };
+
+    QStringList const lines{
+        QStringLiteral("Frame: %1 ms").arg(ms(frame.frameNs)),
+        QStringLiteral("Nodes: %1 paints, %2 ms").arg(frame.nodePaints).arg(ms(frame.nodePaintNs)),
+        QStringLiteral("Connections: %1 paints, %2 ms")
+            .arg(frame.connectionPaints)
+            .arg(ms(frame.connectionPaintNs)),
+        QStringLiteral("Cache: %1 hits, %2 misses").arg(frame.cacheHits).arg(frame.cacheMisses),
+        QStringLiteral("Update: %1 rects, %2 px")
+            .arg(frame.updateRegion.rectCount())
+            .arg(frame.updatePixels)};
+
+    painter->save();
+
+    // The overlay stays in viewport coordinates.
+    painter->resetTransform();
+
+    QString const text = lines.join('\n');
+
+    int const margin = 6;
+
+    QRect const textRect = QFontMetrics(painter->font())
+                               .boundingRect(QRect(10 + margin, 10 + margin, 0, 0),
+                                             Qt::AlignLeft | Qt::AlignTop,
+                                             text);
+
+    _diagnosticsOverlayRect = textRect.adjusted(-margin, -margin, margin, margin);
+
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(0, 0, 0, 160));
+    painter->drawRect(_diagnosticsOverlayRect);
+
+    painter->setPen(Qt::white);
+    painter->drawText(textRect, Qt::AlignLeft | Qt::AlignTop, text);
+
+    painter->restore();
+}
+
+void GraphicsView::paintEvent(QPaintEvent *event)
+{
+    BasicGraphicsScene *scene = nodeScene();
+
+    if (!scene || !scene->renderDiagnostics().isEnabled()) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    auto &diagnostics = scene->renderDiagnostics();
+
+    // Refreshing the overlay alone is not a frame of the scene.
+    bool const overlayOnly = _diagnosticsOverlay
+                             && _diagnosticsOverlayRect.contains(event->region().boundingRect());
+
+    if (overlayOnly) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    diagnostics.beginFrame(event->region());
+
+    QGraphicsView::paintEvent(event);
+
+    QRectF const exposedArea = mapToScene(event->region().boundingRect()).boundingRect();
+
+    std::size_t exposedCachedNodes = 0;
+    for (NodeId const nodeId : scene->spatialIndex().nodesIn(exposedArea)) {
+        NodeGraphicsObject const *ngo = scene->nodeGraphicsObject(nodeId);
+
+        if (!ngo || !ngo->isVisible() || ngo->cacheMode() == QGraphicsItem::NoCache)
+            continue;
+
+        QRect const viewRect = mapFromScene(ngo->sceneBoundingRect()).boundingRect();
+        if (event->region().intersects(viewRect))
+            ++exposedCachedNodes;
+    }
+
+    diagnostics.endFrame(exposedCachedNodes);
+
+    // The overlay shows the frame that just ended.
+    if (_diagnosticsOverlay) {
+        QMetaObject::invokeMethod(
+            this,
+            [this]() { viewport()->update(_diagnosticsOverlayRect); },
+            Qt::QueuedConnection);
+    }
+}
+
+void GraphicsView::setRenderDiagnosticsOverlayEnabled(bool const enabled)
+{
+    _diagnosticsOverlay = enabled;
+
+    if (enabled && nodeScene())
+        nodeScene()->renderDiagnostics().setEnabled(true);
+
+    viewport()->update();
+}
+
 void GraphicsView::showEvent(QShowEvent *event)
 {
     QGraphicsView::showEvent(event);
@@ -446,6 +636,8 @@ QPointF GraphicsView::scenePastePosition()
 void GraphicsView::zoomFitAll()
 {
     fitInView(scene()->itemsBoundingRect(), Qt::KeepAspectRatio);
+
+    Q_EMIT scaleChanged(transform().m11());
 }
 
 void GraphicsView::zoomFitSelected()
@@ -459,5 +651,7 @@ void GraphicsView::zoomFitSelected()
         }
 
         fitInView(unitedBoundingRect, Qt::KeepAspectRatio);
+
+        Q_EMIT scaleChanged(transform().m11());
     }
 }
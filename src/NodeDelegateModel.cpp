@@ -1,13 +1,117 @@
 #include "NodeDelegateModel.hpp"
 
+#include "NodeProfiler.hpp"
 #include "StyleCollection.hpp"
 
+#include <QtCore/QMetaObject>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include <algorithm>
+#include <limits>
+
 namespace QtNodes {
 
+/// When and where the work function of a computation ran.
+struct ComputeTiming
+{
+    /// `NodeProfiler::steadyClockNs()` when the work function was called.
+    qint64 startNs = 0;
+
+    qint64 durationNs = 0;
+
+    Qt::HANDLE thread = nullptr;
+};
+
+/// Executes the work function of `NodeDelegateModel::startCompute()` on the pool.
+class ComputeRunnable : public QRunnable
+{
+public:
+    ComputeRunnable(NodeDelegateModel *model,
+                    ComputeTask task,
+                    std::function<std::function<void()>(ComputeTask const &)> work)
+        : _model(model)
+        , _task(std::move(task))
+        , _work(std::move(work))
+    {}
+
+    void run() override
+    {
+        // A task cancelled while still queued is skipped altogether, and the
+        // model may already be gone.
+        if (!_task.markStarted())
+            return;
+
+        NodeDelegateModel *model = _model;
+        ComputeTask task = _task;
+
+        QMetaObject::invokeMethod(
+            model, [model, task]() { model->onComputeStarted(task); }, Qt::QueuedConnection);
+
+        std::function<void()> publish;
+        bool failed = false;
+
+        // Taken here, the model thread may be busy when the result arrives.
+        ComputeTiming timing;
+        timing.startNs = NodeProfiler::steadyClockNs();
+        timing.thread = QThread::currentThreadId();
+
+        try {
+            publish = _work(task);
+        } catch (...) {
+            failed = true;
+        }
+
+        timing.durationNs = NodeProfiler::steadyClockNs() - timing.startNs;
+
+        QMetaObject::invokeMethod(
+            model,
+            [model, task, publish, failed, timing]() {
+                model->onComputeFinished(task, publish, failed, timing);
+            },
+            Qt::QueuedConnection);
+
+        // The model waits for this in its destructor, it must not be touched
+        // afterwards. Events posted above are discarded with the model.
+        _task.markFinished();
+    }
+
+private:
+    NodeDelegateModel *_model;
+
+    ComputeTask _task;
+
+    std::function<std::function<void()>(ComputeTask const &)> _work;
+};
+
 NodeDelegateModel::NodeDelegateModel()
     : _nodeStyle(StyleCollection::nodeStyle())
 {
     // Derived classes can initialize specific style here
+
+    connect(this,
+            &NodeDelegateModel::portsInserted,
+            this,
+            &NodeDelegateModel::invalidateDataTypeHandles);
+    connect(this,
+            &NodeDelegateModel::portsDeleted,
+            this,
+            &NodeDelegateModel::invalidateDataTypeHandles);
+}
+
+NodeDelegateModel::~NodeDelegateModel()
+{
+    for (auto &task : _outstandingComputes) {
+        task.cancel();
+    }
+
+    // Runs still queued behind unrelated work skip it once cancelled, only
+    // the running ones are waited for.
+    for (auto const &task : _outstandingComputes) {
+        if (task.hasStarted())
+            task.waitForFinished();
+    }
 }
 
 QJsonObject NodeDelegateModel::save() const
@@ -115,9 +219,130 @@ void NodeDelegateModel::setNodeProcessingStatus(NodeProcessingStatus status)
     _processingStatus = status;
 }
 
+DataTypeHandle NodeDelegateModel::dataTypeHandle(PortType const portType,
+                                                 PortIndex const portIndex) const
+{
+    if (portType == PortType::None)
+        return InvalidDataTypeHandle;
+
+    // Not a handle, marks ports whose type is not interned yet.
+    DataTypeHandle const unresolved = std::numeric_limits<DataTypeHandle>::max();
+
+    auto &handles = portType == PortType::In ? _inDataTypeHandles : _outDataTypeHandles;
+
+    if (portIndex >= handles.size()) {
+        unsigned int const count = nPorts(portType);
+
+        if (portIndex >= count)
+            return DataTypeRegistry::intern(dataType(portType, portIndex));
+
+        handles.resize(count, unresolved);
+    }
+
+    DataTypeHandle &handle = handles[portIndex];
+
+    if (handle == unresolved)
+        handle = DataTypeRegistry::intern(dataType(portType, portIndex));
+
+    return handle;
+}
+
+void NodeDelegateModel::invalidateDataTypeHandles()
+{
+    _inDataTypeHandles.clear();
+    _outDataTypeHandles.clear();
+}
+
 void NodeDelegateModel::setBackgroundColor(QColor const &color)
 {
     _nodeStyle.setBackgroundColor(color);
 }
 
+void NodeDelegateModel::cancelCompute()
+{
+    if (!_currentCompute.isValid())
+        return;
+
+    _currentCompute.cancel();
+    _currentCompute = ComputeTask();
+
+    // The outputs no longer reflect the inputs until the next computation.
+    setNodeProcessingStatus(NodeProcessingStatus::Pending);
+
+    Q_EMIT computingFinished();
+    Q_EMIT requestNodeUpdate();
+}
+
+ComputeTask NodeDelegateModel::startComputeImpl(
+    std::function<std::function<void()>(ComputeTask const &)> work)
+{
+    // A superseded run hands the busy state over to the new one.
+    bool const wasIdle = !_currentCompute.isValid();
+
+    _currentCompute.cancel();
+
+    _outstandingComputes.erase(std::remove_if(_outstandingComputes.begin(),
+                                              _outstandingComputes.end(),
+                                              [](ComputeTask const &t) { return t.isFinished(); }),
+                               _outstandingComputes.end());
+
+    auto state = std::make_shared<ComputeTask::State>();
+    state->generation = ++_computeGeneration;
+
+    ComputeTask task(std::move(state));
+
+    _currentCompute = task;
+    _outstandingComputes.push_back(task);
+
+    setNodeProcessingStatus(NodeProcessingStatus::Pending);
+
+    if (wasIdle)
+        Q_EMIT computingStarted();
+
+    Q_EMIT requestNodeUpdate();
+
+    QThreadPool::globalInstance()->start(new ComputeRunnable(this, task, std::move(work)));
+
+    return task;
+}
+
+bool NodeDelegateModel::isCurrentCompute(ComputeTask const &task) const
+{
+    return task == _currentCompute && !task.isCancelled();
+}
+
+void NodeDelegateModel::onComputeStarted(ComputeTask const &task)
+{
+    if (!isCurrentCompute(task))
+        return;
+
+    setNodeProcessingStatus(NodeProcessingStatus::Processing);
+
+    Q_EMIT requestNodeUpdate();
+}
+
+void NodeDelegateModel::onComputeFinished(ComputeTask const &task,
+                                          std::function<void()> const &publish,
+                                          bool failed,
+                                          ComputeTiming const &timing)
+{
+    // Superseded runs took their time as well.
+    Q_EMIT computeTimed(timing.startNs, timing.durationNs, task.generation(), timing.thread);
+
+    // Results of superseded or cancelled runs are dropped.
+    if (!isCurrentCompute(task))
+        return;
+
+    _currentCompute = ComputeTask();
+
+    setNodeProcessingStatus(failed ? NodeProcessingStatus::Failed : NodeProcessingStatus::Updated);
+
+    Q_EMIT computingFinished();
+
+    if (!failed && publish)
+        publish();
+
+    Q_EMIT requestNodeUpdate();
+}
+
 } // namespace QtNodes
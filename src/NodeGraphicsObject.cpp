@@ -11,6 +11,7 @@
 #include "StyleCollection.hpp"
 #include "UndoCommands.hpp"
 
+#include <QtCore/QJsonDocument>
 #include <QtWidgets/QGraphicsEffect>
 #include <QtWidgets/QtWidgets>
 
@@ -60,6 +61,8 @@ NodeGraphicsObject::NodeGraphicsObject(BasicGraphicsScene &scene, NodeId nodeId)
 
     setPos(pos);
 
+    scene.spatialIndex().updateNode(_nodeId, sceneBoundingRect());
+
     connect(&_graphModel, &AbstractGraphModel::nodeFlagsUpdated, this, [this](NodeId const nodeId) {
         if (_nodeId == nodeId)
             setLockedState();
@@ -86,12 +89,32 @@ void NodeGraphicsObject::updateQWidgetEmbedPos()
     }
 }
 
+NodeStyle const &NodeGraphicsObject::nodeStyle() const
+{
+    if (NodeStyle const *style = _graphModel.nodeStyle(_nodeId))
+        return *style;
+
+    if (!_cachedNodeStyle) {
+        QJsonDocument json = QJsonDocument::fromVariant(
+            _graphModel.nodeData(_nodeId, NodeRole::Style));
+
+        _cachedNodeStyle = std::make_unique<NodeStyle>(json.object());
+    }
+
+    return *_cachedNodeStyle;
+}
+
+void NodeGraphicsObject::invalidateNodeStyle()
+{
+    _cachedNodeStyle.reset();
+}
+
 void NodeGraphicsObject::embedQWidget()
 {
     AbstractNodeGeometry &geometry = nodeScene()->nodeGeometry();
     geometry.recomputeSize(_nodeId);
 
-    if (auto w = _graphModel.nodeData(_nodeId, NodeRole::Widget).value<QWidget *>()) {
+    if (auto w = _graphModel.nodeWidget(_nodeId)) {
         _proxyWidget = new QGraphicsProxyWidget(this);
 
         _proxyWidget->setWidget(w);
@@ -115,9 +138,17 @@ void NodeGraphicsObject::embedQWidget()
 
         _proxyWidget->setOpacity(1.0);
         _proxyWidget->setFlag(QGraphicsItem::ItemIgnoresParentOpacity);
+
+        _proxyWidget->setVisible(nodeScene()->nodeWidgetsVisible());
     }
 }
 
+void NodeGraphicsObject::setWidgetVisible(bool const visible)
+{
+    if (_proxyWidget)
+        _proxyWidget->setVisible(visible);
+}
+
 void NodeGraphicsObject::setLockedState()
 {
     NodeFlags flags = _graphModel.nodeFlags(_nodeId);
@@ -174,12 +205,24 @@ void NodeGraphicsObject::paint(QPainter *painter, QStyleOptionGraphicsItem const
 
     painter->setClipRect(option->exposedRect);
 
+    RenderDiagnostics &diagnostics = nodeScene()->renderDiagnostics();
+
+    if (!diagnostics.isEnabled()) {
+        nodeScene()->nodePainter().paint(painter, *this);
+        return;
+    }
+
+    qint64 const start = diagnostics.now();
+
     nodeScene()->nodePainter().paint(painter, *this);
+
+    diagnostics.recordNodePaint(diagnostics.now() - start, cacheMode() != NoCache);
 }
 
 QVariant NodeGraphicsObject::itemChange(GraphicsItemChange change, const QVariant &value)
 {
-    if (change == ItemScenePositionHasChanged && scene()) {
+    // A drag gesture moves the attached connections once per step itself.
+    if (change == ItemScenePositionHasChanged && scene() && !nodeScene()->nodeDragInProgress()) {
         moveConnections();
     }
 
@@ -271,7 +314,7 @@ void NodeGraphicsObject::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     if (_nodeState.resizing()) {
         auto diff = event->pos() - event->lastPos();
 
-        if (auto w = _graphModel.nodeData<QWidget *>(_nodeId, NodeRole::Widget)) {
+        if (auto w = _graphModel.nodeWidget(_nodeId)) {
             prepareGeometryChange();
 
             auto oldSize = w->size();
@@ -285,6 +328,8 @@ void NodeGraphicsObject::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
             // Passes the new size to the model.
             geometry.recomputeSize(_nodeId);
 
+            nodeScene()->spatialIndex().updateNode(_nodeId, sceneBoundingRect());
+
             update();
 
             moveConnections();
@@ -294,7 +339,9 @@ void NodeGraphicsObject::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     } else {
         auto diff = event->pos() - event->lastPos();
 
-        nodeScene()->undoStack().push(new MoveNodeCommand(nodeScene(), diff));
+        // The model and the undo stack are updated once, on release.
+        nodeScene()->beginNodeDrag();
+        nodeScene()->dragNodes(diff);
 
         event->accept();
     }
@@ -310,6 +357,8 @@ void NodeGraphicsObject::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
     _nodeState.setResizing(false);
 
+    nodeScene()->endNodeDrag();
+
     QGraphicsObject::mouseReleaseEvent(event);
 
     // position connections precisely after fast node move
@@ -318,14 +367,23 @@ void NodeGraphicsObject::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
     nodeScene()->nodeClicked(_nodeId);
 }
 
+void NodeGraphicsObject::mouseUngrabEvent(QEvent *event)
+{
+    // The grab can be lost without a release, e.g. to a popup.
+    if (auto scene = nodeScene())
+        scene->endNodeDrag();
+
+    QGraphicsObject::mouseUngrabEvent(event);
+}
+
 void NodeGraphicsObject::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
-    // bring all the colliding nodes to background
-    QList<QGraphicsItem *> overlapItems = collidingItems();
+    // bring all the overlapping nodes to background
+    for (NodeId const nodeId : nodeScene()->spatialIndex().nodesIn(sceneBoundingRect())) {
+        NodeGraphicsObject *ngo = nodeScene()->nodeGraphicsObject(nodeId);
 
-    for (QGraphicsItem *item : overlapItems) {
-        if (item->zValue() > 0.0) {
-            item->setZValue(0.0);
+        if (ngo && ngo->zValue() > 0.0) {
+            ngo->setZValue(0.0);
         }
     }
 
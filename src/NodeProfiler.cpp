@@ -0,0 +1,236 @@
+#include "NodeProfiler.hpp"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace QtNodes {
+
+NodeProfiler::NodeProfiler()
+    : _originNs(steadyClockNs())
+{}
+
+void NodeProfiler::setEnabled(bool const enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void NodeProfiler::clear()
+{
+    QMutexLocker locker(&_mutex);
+
+    _stats.clear();
+    _maxTotalNs = 0;
+    _events.clear();
+    _threads.clear();
+}
+
+void NodeProfiler::setMaxEvents(std::size_t const count)
+{
+    QMutexLocker locker(&_mutex);
+
+    _maxEvents = count;
+
+    while (_events.size() > _maxEvents)
+        _events.pop_front();
+}
+
+NodeProfiler::NodeStats NodeProfiler::stats(NodeId const nodeId) const
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = _stats.find(nodeId);
+
+    return it != _stats.end() ? it->second : NodeStats{};
+}
+
+std::unordered_map<NodeId, NodeProfiler::NodeStats> NodeProfiler::allStats() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return _stats;
+}
+
+qint64 NodeProfiler::maxTotalNs() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return _maxTotalNs;
+}
+
+std::vector<NodeProfiler::Event> NodeProfiler::events() const
+{
+    QMutexLocker locker(&_mutex);
+
+    return std::vector<Event>(_events.begin(), _events.end());
+}
+
+std::vector<NodeId> NodeProfiler::causeChain(NodeId const nodeId) const
+{
+    QMutexLocker locker(&_mutex);
+
+    std::vector<NodeId> chain;
+
+    // Latest causes of different flushes can form a loop.
+    std::unordered_set<NodeId> visited;
+
+    NodeId id = nodeId;
+    while (id != InvalidNodeId && visited.insert(id).second) {
+        chain.push_back(id);
+
+        auto it = _stats.find(id);
+        id = it != _stats.end() ? it->second.lastCause : InvalidNodeId;
+    }
+
+    return chain;
+}
+
+QJsonObject NodeProfiler::chromeTrace(std::function<QString(NodeId)> const &nodeName) const
+{
+    QMutexLocker locker(&_mutex);
+
+    QJsonArray traceEvents;
+
+    for (auto const &t : _threads) {
+        QJsonObject metadata;
+        metadata["name"] = QStringLiteral("thread_name");
+        metadata["ph"] = QStringLiteral("M");
+        metadata["pid"] = 1;
+        metadata["tid"] = t.second;
+        metadata["args"] = QJsonObject{{"name", QStringLiteral("Thread %1").arg(t.second)}};
+
+        traceEvents.append(metadata);
+    }
+
+    for (Event const &e : _events) {
+        QJsonObject args;
+        args["nodeId"] = static_cast<qint64>(e.nodeId);
+        if (e.causeId != InvalidNodeId)
+            args["causeId"] = static_cast<qint64>(e.causeId);
+
+        QJsonObject event;
+        event["name"] = nodeName ? nodeName(e.nodeId) : QString::number(e.nodeId);
+        event["pid"] = 1;
+        event["tid"] = e.thread;
+        event["args"] = args;
+
+        // Trace timestamps are in microseconds.
+        if (!e.compute) {
+            event["cat"] = QStringLiteral("node");
+            event["ph"] = QStringLiteral("X");
+            event["ts"] = e.startNs / 1000.0;
+            event["dur"] = e.durationNs / 1000.0;
+
+            traceEvents.append(event);
+            continue;
+        }
+
+        // Runs overlap, also a superseded run and its successor, so they
+        // become async slices told apart by the node and the generation.
+        event["cat"] = QStringLiteral("compute");
+        event["id"] = QStringLiteral("%1.%2").arg(e.nodeId).arg(e.generation);
+        event["ph"] = QStringLiteral("b");
+        event["ts"] = e.startNs / 1000.0;
+        traceEvents.append(event);
+
+        event["ph"] = QStringLiteral("e");
+        event["ts"] = (e.startNs + e.durationNs) / 1000.0;
+        traceEvents.append(event);
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = traceEvents;
+    trace["displayTimeUnit"] = QStringLiteral("ns");
+
+    return trace;
+}
+
+void NodeProfiler::recordInvocation(NodeId const nodeId,
+                                    NodeId const causeId,
+                                    qint64 const startNs,
+                                    qint64 const durationNs)
+{
+    QMutexLocker locker(&_mutex);
+
+    NodeStats &s = _stats[nodeId];
+    ++s.invocations;
+    s.totalNs += durationNs;
+    s.maxNs = std::max(s.maxNs, durationNs);
+    s.lastCause = causeId;
+
+    _maxTotalNs = std::max(_maxTotalNs, s.totalNs);
+
+    if (_maxEvents == 0)
+        return;
+
+    if (_events.size() >= _maxEvents)
+        _events.pop_front();
+
+    _events.push_back(Event{nodeId, causeId, startNs, durationNs, threadIndex()});
+}
+
+void NodeProfiler::recordCompute(NodeId const nodeId,
+                                 qint64 const startNs,
+                                 qint64 const durationNs,
+                                 quint64 const generation,
+                                 Qt::HANDLE const thread)
+{
+    QMutexLocker locker(&_mutex);
+
+    NodeStats &s = _stats[nodeId];
+    s.totalNs += durationNs;
+    s.maxNs = std::max(s.maxNs, durationNs);
+
+    _maxTotalNs = std::max(_maxTotalNs, s.totalNs);
+
+    if (_maxEvents == 0)
+        return;
+
+    if (_events.size() >= _maxEvents)
+        _events.pop_front();
+
+    _events.push_back(
+        Event{nodeId, s.lastCause, startNs, durationNs, threadIndex(thread), true, generation});
+}
+
+void NodeProfiler::recordBytes(NodeId const nodeId, std::size_t const bytes)
+{
+    QMutexLocker locker(&_mutex);
+
+    _stats[nodeId].bytesProduced += bytes;
+}
+
+void NodeProfiler::removeNode(NodeId const nodeId)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = _stats.find(nodeId);
+    if (it == _stats.end())
+        return;
+
+    bool const wasHottest = it->second.totalNs == _maxTotalNs;
+
+    _stats.erase(it);
+
+    if (wasHottest) {
+        _maxTotalNs = 0;
+        for (auto const &s : _stats)
+            _maxTotalNs = std::max(_maxTotalNs, s.second.totalNs);
+    }
+}
+
+int NodeProfiler::threadIndex()
+{
+    return threadIndex(QThread::currentThreadId());
+}
+
+int NodeProfiler::threadIndex(Qt::HANDLE const thread)
+{
+    auto const key = reinterpret_cast<quintptr>(thread);
+
+    return _threads.emplace(key, static_cast<int>(_threads.size())).first->second;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,72 @@
+#include "RenderDiagnostics.hpp"
+
+#include <utility>
+
+namespace QtNodes {
+
+RenderDiagnostics::RenderDiagnostics()
+{
+    _clock.start();
+}
+
+void RenderDiagnostics::reset()
+{
+    _current = Frame();
+    _lastFrame = Frame();
+    _totals = Frame();
+    _frameCount = 0;
+}
+
+void RenderDiagnostics::beginFrame(QRegion const &updateRegion)
+{
+    // Paints outside of a view, e.g. QGraphicsScene::render(), are kept and
+    // reported with the next frame.
+    _current.updateRegion = updateRegion;
+
+    _current.updatePixels = 0;
+    for (QRect const &r : updateRegion)
+        _current.updatePixels += qint64(r.width()) * r.height();
+
+    _frameStart = now();
+}
+
+void RenderDiagnostics::endFrame(std::size_t const exposedCachedNodes)
+{
+    _current.frameNs = now() - _frameStart;
+
+    // Exposed nodes whose caches were not regenerated were drawn from them.
+    _current.cacheHits = exposedCachedNodes > _current.cacheMisses
+                             ? exposedCachedNodes - _current.cacheMisses
+                             : 0;
+
+    _totals.nodePaints += _current.nodePaints;
+    _totals.connectionPaints += _current.connectionPaints;
+    _totals.nodePaintNs += _current.nodePaintNs;
+    _totals.connectionPaintNs += _current.connectionPaintNs;
+    _totals.cacheHits += _current.cacheHits;
+    _totals.cacheMisses += _current.cacheMisses;
+    _totals.updatePixels += _current.updatePixels;
+    _totals.frameNs += _current.frameNs;
+
+    ++_frameCount;
+
+    _lastFrame = std::move(_current);
+    _current = Frame();
+}
+
+void RenderDiagnostics::recordNodePaint(qint64 const durationNs, bool const cached)
+{
+    ++_current.nodePaints;
+    _current.nodePaintNs += durationNs;
+
+    if (cached)
+        ++_current.cacheMisses;
+}
+
+void RenderDiagnostics::recordConnectionPaint(qint64 const durationNs)
+{
+    ++_current.connectionPaints;
+    _current.connectionPaintNs += durationNs;
+}
+
+} // namespace QtNodes
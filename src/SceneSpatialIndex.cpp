@@ -0,0 +1,227 @@
+#include "SceneSpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace QtNodes {
+
+namespace {
+
+/// Items spanning more cells are not worth distributing over the grid.
+std::size_t const MaxCellsPerItem = 64;
+
+int toCell(qreal const coordinate, qreal const cellSize)
+{
+    qreal const cell = std::floor(coordinate / cellSize);
+
+    return static_cast<int>(qBound<qreal>(std::numeric_limits<int>::min(),
+                                          cell,
+                                          std::numeric_limits<int>::max()));
+}
+
+quint64 cellKey(int const x, int const y)
+{
+    return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+} // namespace
+
+std::size_t SceneSpatialIndex::CellRange::cellCount() const
+{
+    return static_cast<std::size_t>(qint64(right) - left + 1)
+           * static_cast<std::size_t>(qint64(bottom) - top + 1);
+}
+
+bool SceneSpatialIndex::CellRange::operator==(CellRange const &other) const
+{
+    return left == other.left && top == other.top && right == other.right
+           && bottom == other.bottom;
+}
+
+SceneSpatialIndex::SceneSpatialIndex(qreal const cellSize)
+    : _cellSize(cellSize > 0.0 ? cellSize : 256.0)
+{}
+
+void SceneSpatialIndex::updateNode(NodeId const nodeId, QRectF const &sceneRect)
+{
+    update(_nodes, nodeId, sceneRect);
+}
+
+void SceneSpatialIndex::removeNode(NodeId const nodeId)
+{
+    remove(_nodes, nodeId);
+}
+
+void SceneSpatialIndex::updateConnection(ConnectionId const &connectionId,
+                                         QRectF const &sceneRect)
+{
+    update(_connections, connectionId, sceneRect);
+}
+
+void SceneSpatialIndex::removeConnection(ConnectionId const &connectionId)
+{
+    remove(_connections, connectionId);
+}
+
+void SceneSpatialIndex::clear()
+{
+    _nodes = Grid<NodeId>();
+    _connections = Grid<ConnectionId>();
+}
+
+std::vector<NodeId> SceneSpatialIndex::nodesAt(QPointF const &scenePoint) const
+{
+    return query(_nodes, QRectF(scenePoint, QSizeF(0.0, 0.0)), [&scenePoint](QRectF const &r) {
+        return r.contains(scenePoint);
+    });
+}
+
+std::vector<NodeId> SceneSpatialIndex::nodesIn(QRectF const &sceneRect) const
+{
+    return query(_nodes, sceneRect, [&sceneRect](QRectF const &r) {
+        return r.intersects(sceneRect);
+    });
+}
+
+std::vector<ConnectionId> SceneSpatialIndex::connectionsIn(QRectF const &sceneRect) const
+{
+    return query(_connections, sceneRect, [&sceneRect](QRectF const &r) {
+        return r.intersects(sceneRect);
+    });
+}
+
+SceneSpatialIndex::CellRange SceneSpatialIndex::cellRange(QRectF const &rect) const
+{
+    QRectF const r = rect.normalized();
+
+    return CellRange{toCell(r.left(), _cellSize),
+                     toCell(r.top(), _cellSize),
+                     toCell(r.right(), _cellSize),
+                     toCell(r.bottom(), _cellSize)};
+}
+
+template<typename Id>
+void SceneSpatialIndex::update(Grid<Id> &grid, Id const &id, QRectF const &rect)
+{
+    CellRange const cells = cellRange(rect);
+
+    auto it = grid.entries.find(id);
+
+    if (it != grid.entries.end()) {
+        // Small moves keep the item within its cells.
+        if (it->second.cells == cells) {
+            it->second.rect = rect;
+            return;
+        }
+
+        unlink(grid, id, it->second);
+    }
+
+    bool const oversized = cells.cellCount() > MaxCellsPerItem;
+
+    grid.entries[id] = typename Grid<Id>::Entry{rect, cells, oversized};
+
+    if (oversized) {
+        grid.oversized.insert(id);
+        return;
+    }
+
+    for (int x = cells.left; x <= cells.right; ++x) {
+        for (int y = cells.top; y <= cells.bottom; ++y)
+            grid.cells[cellKey(x, y)].push_back(id);
+    }
+}
+
+template<typename Id>
+void SceneSpatialIndex::remove(Grid<Id> &grid, Id const &id)
+{
+    auto it = grid.entries.find(id);
+
+    if (it == grid.entries.end())
+        return;
+
+    unlink(grid, id, it->second);
+
+    grid.entries.erase(it);
+}
+
+template<typename Id>
+void SceneSpatialIndex::unlink(Grid<Id> &grid, Id const &id, typename Grid<Id>::Entry const &entry)
+{
+    if (entry.oversized) {
+        grid.oversized.erase(id);
+        return;
+    }
+
+    for (int x = entry.cells.left; x <= entry.cells.right; ++x) {
+        for (int y = entry.cells.top; y <= entry.cells.bottom; ++y) {
+            auto cellIt = grid.cells.find(cellKey(x, y));
+
+            if (cellIt == grid.cells.end())
+                continue;
+
+            auto &ids = cellIt->second;
+
+            auto idIt = std::find(ids.begin(), ids.end(), id);
+            if (idIt != ids.end()) {
+                *idIt = ids.back();
+                ids.pop_back();
+            }
+
+            if (ids.empty())
+                grid.cells.erase(cellIt);
+        }
+    }
+}
+
+template<typename Id, typename Predicate>
+std::vector<Id> SceneSpatialIndex::query(Grid<Id> const &grid,
+                                         QRectF const &area,
+                                         Predicate accept) const
+{
+    std::vector<Id> result;
+
+    CellRange const cells = cellRange(area);
+
+    // Visiting every cell of a huge area is slower than a plain scan.
+    if (cells.cellCount() > grid.entries.size()) {
+        for (auto const &entry : grid.entries) {
+            if (accept(entry.second.rect))
+                result.push_back(entry.first);
+        }
+
+        return result;
+    }
+
+    for (Id const &id : grid.oversized) {
+        if (accept(grid.entries.at(id).rect))
+            result.push_back(id);
+    }
+
+    bool const singleCell = cells.cellCount() == 1;
+
+    std::unordered_set<Id> seen;
+
+    for (int x = cells.left; x <= cells.right; ++x) {
+        for (int y = cells.top; y <= cells.bottom; ++y) {
+            auto cellIt = grid.cells.find(cellKey(x, y));
+
+            if (cellIt == grid.cells.end())
+                continue;
+
+            for (Id const &id : cellIt->second) {
+                // Items spanning several cells are met more than once.
+                if (!singleCell && !seen.insert(id).second)
+                    continue;
+
+                if (accept(grid.entries.at(id).rect))
+                    result.push_back(id);
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,284 @@
+#include "TopologicalOrder.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_set>
+#include <utility>
+
+namespace QtNodes {
+
+void TopologicalOrder::addNode(NodeId const nodeId)
+{
+    if (hasNode(nodeId))
+        return;
+
+    // A node without edges may be placed anywhere, the end is the cheapest.
+    _nodes[nodeId].rank = _nextRank++;
+}
+
+void TopologicalOrder::removeNode(NodeId const nodeId)
+{
+    auto it = _nodes.find(nodeId);
+    if (it == _nodes.end())
+        return;
+
+    for (auto const &s : it->second.successors)
+        _nodes[s.first].predecessors.erase(nodeId);
+
+    for (auto const &p : it->second.predecessors)
+        _nodes[p.first].successors.erase(nodeId);
+
+    _nodes.erase(it);
+
+    if (!_valid)
+        rebuild();
+}
+
+bool TopologicalOrder::hasNode(NodeId const nodeId) const
+{
+    return _nodes.find(nodeId) != _nodes.end();
+}
+
+void TopologicalOrder::addEdge(NodeId const from, NodeId const to)
+{
+    addNode(from);
+    addNode(to);
+
+    unsigned int const multiplicity = ++_nodes[from].successors[to];
+    ++_nodes[to].predecessors[from];
+
+    // Parallel edge, the order already accounts for it.
+    if (multiplicity > 1)
+        return;
+
+    if (!_valid)
+        return;
+
+    if (from == to) {
+        _valid = false;
+        return;
+    }
+
+    if (_nodes[from].rank > _nodes[to].rank && !reorder(from, to))
+        _valid = false;
+}
+
+void TopologicalOrder::removeEdge(NodeId const from, NodeId const to)
+{
+    auto fromIt = _nodes.find(from);
+    auto toIt = _nodes.find(to);
+
+    if (fromIt == _nodes.end() || toIt == _nodes.end())
+        return;
+
+    auto &successors = fromIt->second.successors;
+    auto sIt = successors.find(to);
+
+    if (sIt == successors.end())
+        return;
+
+    if (--sIt->second > 0) {
+        --toIt->second.predecessors[from];
+        return;
+    }
+
+    successors.erase(sIt);
+    toIt->second.predecessors.erase(from);
+
+    // The removed edge could have been the one closing the cycle.
+    if (!_valid)
+        rebuild();
+}
+
+bool TopologicalOrder::wouldCreateCycle(NodeId const from, NodeId const to) const
+{
+    if (from == to)
+        return true;
+
+    auto fromIt = _nodes.find(from);
+    auto toIt = _nodes.find(to);
+
+    if (fromIt == _nodes.end() || toIt == _nodes.end())
+        return false;
+
+    if (!_valid)
+        return reaches(to, from, std::numeric_limits<Rank>::max());
+
+    // The edge agrees with the current order.
+    if (fromIt->second.rank < toIt->second.rank)
+        return false;
+
+    // Any path `to -> ... -> from` only passes nodes ranked up to `from`.
+    return reaches(to, from, fromIt->second.rank);
+}
+
+TopologicalOrder::Rank TopologicalOrder::rank(NodeId const nodeId) const
+{
+    auto it = _nodes.find(nodeId);
+
+    if (it == _nodes.end())
+        return -1;
+
+    return it->second.rank;
+}
+
+std::vector<NodeId> TopologicalOrder::sortedNodes() const
+{
+    std::vector<NodeId> result;
+    result.reserve(_nodes.size());
+
+    for (auto const &n : _nodes)
+        result.push_back(n.first);
+
+    std::sort(result.begin(), result.end(), [this](NodeId const a, NodeId const b) {
+        return _nodes.at(a).rank < _nodes.at(b).rank;
+    });
+
+    return result;
+}
+
+void TopologicalOrder::clear()
+{
+    _nodes.clear();
+    _nextRank = 0;
+    _valid = true;
+}
+
+bool TopologicalOrder::reorder(NodeId const from, NodeId const to)
+{
+    Rank const lowerBound = _nodes[to].rank;
+    Rank const upperBound = _nodes[from].rank;
+
+    // Forward search: nodes reachable from `to` that are ranked before `from`.
+    std::vector<NodeId> deltaF;
+    {
+        std::unordered_set<NodeId> visited{to};
+        std::vector<NodeId> stack{to};
+
+        while (!stack.empty()) {
+            NodeId const id = stack.back();
+            stack.pop_back();
+            deltaF.push_back(id);
+
+            for (auto const &s : _nodes[id].successors) {
+                if (s.first == from)
+                    return false;
+
+                if (_nodes[s.first].rank < upperBound && visited.insert(s.first).second)
+                    stack.push_back(s.first);
+            }
+        }
+    }
+
+    // Backward search: nodes reaching `from` that are ranked after `to`.
+    std::vector<NodeId> deltaB;
+    {
+        std::unordered_set<NodeId> visited{from};
+        std::vector<NodeId> stack{from};
+
+        while (!stack.empty()) {
+            NodeId const id = stack.back();
+            stack.pop_back();
+            deltaB.push_back(id);
+
+            for (auto const &p : _nodes[id].predecessors) {
+                if (_nodes[p.first].rank > lowerBound && visited.insert(p.first).second)
+                    stack.push_back(p.first);
+            }
+        }
+    }
+
+    auto byRank = [this](NodeId const a, NodeId const b) {
+        return _nodes[a].rank < _nodes[b].rank;
+    };
+
+    std::sort(deltaF.begin(), deltaF.end(), byRank);
+    std::sort(deltaB.begin(), deltaB.end(), byRank);
+
+    // Everything leading to `from` goes first, everything after `to` goes
+    // second. Both groups reuse the pool of ranks they occupied before.
+    std::vector<NodeId> affected;
+    affected.reserve(deltaB.size() + deltaF.size());
+    affected.insert(affected.end(), deltaB.begin(), deltaB.end());
+    affected.insert(affected.end(), deltaF.begin(), deltaF.end());
+
+    std::vector<Rank> pool;
+    pool.reserve(affected.size());
+    for (NodeId const id : affected)
+        pool.push_back(_nodes[id].rank);
+
+    std::sort(pool.begin(), pool.end());
+
+    for (std::size_t i = 0; i < affected.size(); ++i)
+        _nodes[affected[i]].rank = pool[i];
+
+    return true;
+}
+
+bool TopologicalOrder::reaches(NodeId const start, NodeId const target, Rank const upperBound) const
+{
+    std::unordered_set<NodeId> visited{start};
+    std::vector<NodeId> stack{start};
+
+    while (!stack.empty()) {
+        NodeId const id = stack.back();
+        stack.pop_back();
+
+        if (id == target)
+            return true;
+
+        for (auto const &s : _nodes.at(id).successors) {
+            if (_nodes.at(s.first).rank <= upperBound && visited.insert(s.first).second)
+                stack.push_back(s.first);
+        }
+    }
+
+    return false;
+}
+
+void TopologicalOrder::rebuild()
+{
+    using Entry = std::pair<Rank, NodeId>;
+
+    // Ready nodes are taken in their previous order to keep ranks stable.
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> ready;
+
+    std::unordered_map<NodeId, std::size_t> inDegree;
+    inDegree.reserve(_nodes.size());
+
+    for (auto const &n : _nodes) {
+        inDegree[n.first] = n.second.predecessors.size();
+
+        if (n.second.predecessors.empty())
+            ready.emplace(n.second.rank, n.first);
+    }
+
+    std::vector<NodeId> order;
+    order.reserve(_nodes.size());
+
+    while (!ready.empty()) {
+        NodeId const id = ready.top().second;
+        ready.pop();
+        order.push_back(id);
+
+        for (auto const &s : _nodes[id].successors) {
+            if (--inDegree[s.first] == 0)
+                ready.emplace(_nodes[s.first].rank, s.first);
+        }
+    }
+
+    _valid = (order.size() == _nodes.size());
+
+    if (!_valid)
+        return;
+
+    Rank r = 0;
+    for (NodeId const id : order)
+        _nodes[id].rank = r++;
+
+    _nextRank = r;
+}
+
+} // namespace QtNodes
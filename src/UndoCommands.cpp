@@ -13,6 +13,9 @@
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QGraphicsObject>
 
+#include <exception>
+#include <utility>
+#include <vector>
 
 namespace QtNodes {
 
@@ -52,81 +55,185 @@ static QJsonObject serializeSelectedItems(BasicGraphicsScene *scene)
     return serializedScene;
 }
 
-static void insertSerializedItems(QJsonObject const &json, BasicGraphicsScene *scene)
+static GraphFragment::Node saveFragmentNode(AbstractGraphModel const &graphModel,
+                                            NodeId const nodeId)
 {
-    AbstractGraphModel &graphModel = scene->graphModel();
-
-    QJsonArray const &nodesJsonArray = json["nodes"].toArray();
+    GraphFragment::Node node{nodeId,
+                             graphModel.nodeData(nodeId, NodeRole::Position).value<QPointF>(),
+                             graphModel.saveNodeState(nodeId),
+                             QJsonObject()};
 
-    for (QJsonValue node : nodesJsonArray) {
-        QJsonObject obj = node.toObject();
+    if (node.state.isEmpty())
+        node.json = graphModel.saveNode(nodeId);
 
-        graphModel.loadNode(obj);
+    return node;
+}
 
-        auto id = obj["id"].toInt();
-        scene->nodeGraphicsObject(id)->setZValue(1.0);
-        scene->nodeGraphicsObject(id)->setSelected(true);
+static void restoreFragmentNode(AbstractGraphModel &graphModel, GraphFragment::Node const &node)
+{
+    if (!node.state.isEmpty()) {
+        graphModel.restoreNodeState(node.id, node.position, node.state);
+        return;
     }
 
-    QJsonArray const &connJsonArray = json["connections"].toArray();
+    QJsonObject nodeJson = node.json;
+
+    nodeJson["id"] = static_cast<qint64>(node.id);
 
-    for (QJsonValue connection : connJsonArray) {
-        QJsonObject connJson = connection.toObject();
+    QJsonObject posJson;
+    posJson["x"] = node.position.x();
+    posJson["y"] = node.position.y();
+    nodeJson["position"] = posJson;
 
-        ConnectionId connId = fromJson(connJson);
+    graphModel.loadNode(nodeJson);
+}
 
-        // Restore the connection
-        graphModel.addConnection(connId);
+/// Reads the clipboard format written by `serializeSelectedItems`.
+static GraphFragment fragmentFromJson(QJsonObject const &sceneJson)
+{
+    GraphFragment fragment;
 
-        scene->connectionGraphicsObject(connId)->setSelected(true);
+    QJsonArray const nodesJsonArray = sceneJson["nodes"].toArray();
+    fragment.nodes.reserve(nodesJsonArray.size());
+
+    for (QJsonValue const node : nodesJsonArray) {
+        QJsonObject const nodeJson = node.toObject();
+        QJsonObject const posJson = nodeJson["position"].toObject();
+
+        fragment.nodes.push_back(
+            GraphFragment::Node{static_cast<NodeId>(nodeJson["id"].toInt()),
+                                QPointF(posJson["x"].toDouble(), posJson["y"].toDouble()),
+                                QByteArray(),
+                                nodeJson});
     }
+
+    QJsonArray const connJsonArray = sceneJson["connections"].toArray();
+    fragment.connections.reserve(connJsonArray.size());
+
+    for (QJsonValue const connection : connJsonArray) {
+        fragment.connections.push_back(fromJson(connection.toObject()));
+    }
+
+    return fragment;
 }
 
-static void deleteSerializedItems(QJsonObject &sceneJson, AbstractGraphModel &graphModel)
+/**
+ * Restores the nodes and connections of `fragment` and selects them. If a node
+ * cannot be restored, the nodes restored so far are deleted again before the
+ * batch ends and the exception is rethrown; `restored` then lists them.
+ */
+static void insertFragment(GraphFragment const &fragment,
+                           BasicGraphicsScene *scene,
+                           std::vector<NodeId> &restored)
 {
-    QJsonArray connectionJsonArray = sceneJson["connections"].toArray();
+    AbstractGraphModel &graphModel = scene->graphModel();
 
-    for (QJsonValueRef connection : connectionJsonArray) {
-        QJsonObject connJson = connection.toObject();
+    restored.clear();
 
-        ConnectionId connId = fromJson(connJson);
+    std::exception_ptr error;
 
-        graphModel.deleteConnection(connId);
+    {
+        // The scene builds all graphics objects in one pass when the batch ends.
+        GraphChangeBatch batch(graphModel);
+
+        try {
+            for (auto const &node : fragment.nodes) {
+                // A node can exist even though restoring its state threw.
+                try {
+                    restoreFragmentNode(graphModel, node);
+                } catch (...) {
+                    if (graphModel.nodeExists(node.id))
+                        restored.push_back(node.id);
+                    throw;
+                }
+
+                restored.push_back(node.id);
+            }
+
+            for (auto const &connId : fragment.connections) {
+                graphModel.addConnection(connId);
+            }
+        } catch (...) {
+            error = std::current_exception();
+
+            // `deleteNode(...)` implicitly removes the connections.
+            for (NodeId const nodeId : restored) {
+                graphModel.deleteNode(nodeId);
+            }
+        }
     }
 
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
+    if (error)
+        std::rethrow_exception(error);
 
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject nodeJson = node.toObject();
-        graphModel.deleteNode(nodeJson["id"].toInt());
+    for (auto const &node : fragment.nodes) {
+        if (auto ngo = scene->nodeGraphicsObject(node.id)) {
+            ngo->setZValue(1.0);
+            ngo->setSelected(true);
+        }
+    }
+
+    for (auto const &connId : fragment.connections) {
+        if (auto cgo = scene->connectionGraphicsObject(connId))
+            cgo->setSelected(true);
     }
 }
 
-static QPointF computeAverageNodePosition(QJsonObject const &sceneJson)
+static void insertFragment(GraphFragment const &fragment, BasicGraphicsScene *scene)
 {
-    QPointF averagePos(0, 0);
+    std::vector<NodeId> restored;
 
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
+    insertFragment(fragment, scene, restored);
+}
 
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject nodeJson = node.toObject();
+static void deleteFragment(GraphFragment const &fragment, AbstractGraphModel &graphModel)
+{
+    GraphChangeBatch batch(graphModel);
+
+    for (auto const &connId : fragment.connections) {
+        graphModel.deleteConnection(connId);
+    }
+
+    for (auto const &node : fragment.nodes) {
+        graphModel.deleteNode(node.id);
+    }
+}
 
-        averagePos += QPointF(nodeJson["position"].toObject()["x"].toDouble(),
-                              nodeJson["position"].toObject()["y"].toDouble());
+static QPointF computeAverageNodePosition(GraphFragment const &fragment)
+{
+    QPointF averagePos(0, 0);
+
+    for (auto const &node : fragment.nodes) {
+        averagePos += node.position;
     }
 
-    averagePos /= static_cast<double>(nodesJsonArray.size());
+    averagePos /= static_cast<double>(fragment.nodes.size());
 
     return averagePos;
 }
 
+std::size_t GraphFragment::byteSize() const
+{
+    std::size_t size = sizeof(GraphFragment) + nodes.capacity() * sizeof(Node)
+                       + connections.capacity() * sizeof(ConnectionId);
+
+    for (auto const &node : nodes) {
+        size += static_cast<std::size_t>(node.state.capacity());
+
+        if (!node.json.isEmpty())
+            size += static_cast<std::size_t>(
+                QJsonDocument(node.json).toJson(QJsonDocument::Compact).size());
+    }
+
+    return size;
+}
+
 //-------------------------------------
 
 CreateCommand::CreateCommand(BasicGraphicsScene *scene,
                              QString const name,
                              QPointF const &mouseScenePos)
     : _scene(scene)
-    , _sceneJson(QJsonObject())
 {
     _nodeId = _scene->graphModel().addNode(name);
     if (_nodeId != InvalidNodeId) {
@@ -138,19 +245,29 @@ CreateCommand::CreateCommand(BasicGraphicsScene *scene,
 
 void CreateCommand::undo()
 {
-    QJsonArray nodesJsonArray;
-    nodesJsonArray.append(_scene->graphModel().saveNode(_nodeId));
-    _sceneJson["nodes"] = nodesJsonArray;
+    _fragment.nodes.assign(1, saveFragmentNode(_scene->graphModel(), _nodeId));
+    _fragmentSize = _fragment.byteSize();
 
     _scene->graphModel().deleteNode(_nodeId);
 }
 
 void CreateCommand::redo()
 {
-    if (_sceneJson.empty() || _sceneJson["nodes"].toArray().empty())
+    if (_fragment.nodes.empty())
         return;
 
-    insertSerializedItems(_sceneJson, _scene);
+    insertFragment(_fragment, _scene);
+}
+
+std::size_t CreateCommand::byteSize() const
+{
+    return sizeof(CreateCommand) + _fragmentSize;
+}
+
+void CreateCommand::releaseState()
+{
+    _fragment = GraphFragment();
+    _fragmentSize = 0;
 }
 
 //-------------------------------------
@@ -160,74 +277,58 @@ DeleteCommand::DeleteCommand(BasicGraphicsScene *scene)
 {
     auto &graphModel = _scene->graphModel();
 
-    QJsonArray connJsonArray;
+    // A connection can be selected and attached to a selected node at once.
+    std::unordered_set<ConnectionId> connections;
+
     // Delete the selected connections first, ensuring that they won't be
     // automatically deleted when selected nodes are deleted (deleting a
     // node deletes some connections as well)
     for (QGraphicsItem *item : _scene->selectedItems()) {
         if (auto c = qgraphicsitem_cast<ConnectionGraphicsObject *>(item)) {
-            auto const &cid = c->connectionId();
-
-            connJsonArray.append(toJson(cid));
+            connections.insert(c->connectionId());
         }
     }
 
-    QJsonArray nodesJsonArray;
     // Delete the nodes; this will delete many of the connections.
     // Selected connections were already deleted prior to this loop,
     for (QGraphicsItem *item : _scene->selectedItems()) {
         if (auto n = qgraphicsitem_cast<NodeGraphicsObject *>(item)) {
             // saving connections attached to the selected nodes
             for (auto const &cid : graphModel.allConnectionIds(n->nodeId())) {
-                connJsonArray.append(toJson(cid));
+                connections.insert(cid);
             }
 
-            nodesJsonArray.append(graphModel.saveNode(n->nodeId()));
+            _fragment.nodes.push_back(saveFragmentNode(graphModel, n->nodeId()));
         }
     }
 
+    _fragment.connections.assign(connections.begin(), connections.end());
+    _fragmentSize = _fragment.byteSize();
+
     // If nothing is deleted, cancel this operation
-    if (connJsonArray.isEmpty() && nodesJsonArray.isEmpty())
+    if (_fragment.empty())
         setObsolete(true);
-
-    _sceneJson["nodes"] = nodesJsonArray;
-    _sceneJson["connections"] = connJsonArray;
 }
 
 void DeleteCommand::undo()
 {
-    insertSerializedItems(_sceneJson, _scene);
+    insertFragment(_fragment, _scene);
 }
 
 void DeleteCommand::redo()
 {
-    deleteSerializedItems(_sceneJson, _scene->graphModel());
+    deleteFragment(_fragment, _scene->graphModel());
 }
 
-//-------------------------------------
-
-void offsetNodeGroup(QJsonObject &sceneJson, QPointF const &diff)
+std::size_t DeleteCommand::byteSize() const
 {
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
-
-    QJsonArray newNodesJsonArray;
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject obj = node.toObject();
-
-        QPointF oldPos(obj["position"].toObject()["x"].toDouble(),
-                       obj["position"].toObject()["y"].toDouble());
-
-        oldPos += diff;
-
-        QJsonObject posJson;
-        posJson["x"] = oldPos.x();
-        posJson["y"] = oldPos.y();
-        obj["position"] = posJson;
-
-        newNodesJsonArray.append(obj);
-    }
+    return sizeof(DeleteCommand) + _fragmentSize;
+}
 
-    sceneJson["nodes"] = newNodesJsonArray;
+void DeleteCommand::releaseState()
+{
+    _fragment = GraphFragment();
+    _fragmentSize = 0;
 }
 
 //-------------------------------------
@@ -263,48 +364,76 @@ PasteCommand::PasteCommand(BasicGraphicsScene *scene, QPointF const &mouseSceneP
     : _scene(scene)
     , _mouseScenePos(mouseScenePos)
 {
-    _newSceneJson = takeSceneJsonFromClipboard();
+    QJsonObject const sceneJson = takeSceneJsonFromClipboard();
 
-    if (_newSceneJson.empty() || _newSceneJson["nodes"].toArray().empty()) {
+    if (sceneJson.empty() || sceneJson["nodes"].toArray().empty()) {
         setObsolete(true);
         return;
     }
 
-    _newSceneJson = makeNewNodeIdsInScene(_newSceneJson);
+    _newFragment = fragmentFromJson(sceneJson);
 
-    QPointF averagePos = computeAverageNodePosition(_newSceneJson);
+    makeNewNodeIdsInScene(_newFragment);
 
-    offsetNodeGroup(_newSceneJson, _mouseScenePos - averagePos);
+    QPointF const diff = _mouseScenePos - computeAverageNodePosition(_newFragment);
+
+    for (auto &node : _newFragment.nodes) {
+        node.position += diff;
+    }
+
+    _fragmentSize = _newFragment.byteSize();
 }
 
 void PasteCommand::undo()
 {
-    deleteSerializedItems(_newSceneJson, _scene->graphModel());
+    auto &graphModel = _scene->graphModel();
+
+    // Later redos restore the nodes from their compact state rather than
+    // from the clipboard JSON.
+    for (auto &node : _newFragment.nodes) {
+        if (graphModel.nodeExists(node.id))
+            node = saveFragmentNode(graphModel, node.id);
+    }
+
+    _fragmentSize = _newFragment.byteSize();
+
+    deleteFragment(_newFragment, graphModel);
 }
 
 void PasteCommand::redo()
 {
     _scene->clearSelection();
 
+    std::vector<NodeId> restored;
+
     // Ignore if pasted in content does not generate nodes.
     try {
-        insertSerializedItems(_newSceneJson, _scene);
+        insertFragment(_newFragment, _scene, restored);
     } catch (...) {
-        // If the paste does not work, delete all selected nodes and connections
-        // `deleteNode(...)` implicitly removed connections
+        // insertFragment() deletes the nodes it restored before rethrowing;
+        // whatever a failing deletion left behind is removed here.
         auto &graphModel = _scene->graphModel();
 
-        QJsonArray nodesJsonArray;
-        for (QGraphicsItem *item : _scene->selectedItems()) {
-            if (auto n = qgraphicsitem_cast<NodeGraphicsObject *>(item)) {
-                graphModel.deleteNode(n->nodeId());
-            }
+        for (NodeId const nodeId : restored) {
+            if (graphModel.nodeExists(nodeId))
+                graphModel.deleteNode(nodeId);
         }
 
         setObsolete(true);
     }
 }
 
+std::size_t PasteCommand::byteSize() const
+{
+    return sizeof(PasteCommand) + _fragmentSize;
+}
+
+void PasteCommand::releaseState()
+{
+    _newFragment = GraphFragment();
+    _fragmentSize = 0;
+}
+
 QJsonObject PasteCommand::takeSceneJsonFromClipboard()
 {
     QClipboard const *clipboard = QApplication::clipboard();
@@ -320,52 +449,24 @@ QJsonObject PasteCommand::takeSceneJsonFromClipboard()
     return json.object();
 }
 
-QJsonObject PasteCommand::makeNewNodeIdsInScene(QJsonObject const &sceneJson)
+void PasteCommand::makeNewNodeIdsInScene(GraphFragment &fragment)
 {
     AbstractGraphModel &graphModel = _scene->graphModel();
 
     std::unordered_map<NodeId, NodeId> mapNodeIds;
 
-    QJsonArray nodesJsonArray = sceneJson["nodes"].toArray();
-
-    QJsonArray newNodesJsonArray;
-    for (QJsonValueRef node : nodesJsonArray) {
-        QJsonObject nodeJson = node.toObject();
-
-        NodeId oldNodeId = nodeJson["id"].toInt();
-
-        NodeId newNodeId = graphModel.newNodeId();
+    for (auto &node : fragment.nodes) {
+        NodeId const newNodeId = graphModel.newNodeId();
 
-        mapNodeIds[oldNodeId] = newNodeId;
+        mapNodeIds[node.id] = newNodeId;
 
-        // Replace NodeId in json
-        nodeJson["id"] = static_cast<qint64>(newNodeId);
-
-        newNodesJsonArray.append(nodeJson);
+        node.id = newNodeId;
     }
 
-    QJsonArray connectionJsonArray = sceneJson["connections"].toArray();
-
-    QJsonArray newConnJsonArray;
-    for (QJsonValueRef connection : connectionJsonArray) {
-        QJsonObject connJson = connection.toObject();
-
-        ConnectionId connId = fromJson(connJson);
-
-        ConnectionId newConnId{mapNodeIds[connId.outNodeId],
-                               connId.outPortIndex,
-                               mapNodeIds[connId.inNodeId],
-                               connId.inPortIndex};
-
-        newConnJsonArray.append(toJson(newConnId));
+    for (auto &connId : fragment.connections) {
+        connId.outNodeId = mapNodeIds[connId.outNodeId];
+        connId.inNodeId = mapNodeIds[connId.inNodeId];
     }
-
-    QJsonObject newSceneJson;
-
-    newSceneJson["nodes"] = newNodesJsonArray;
-    newSceneJson["connections"] = newConnJsonArray;
-
-    return newSceneJson;
 }
 
 //-------------------------------------
@@ -387,6 +488,11 @@ void DisconnectCommand::redo()
     _scene->graphModel().deleteConnection(_connId);
 }
 
+std::size_t DisconnectCommand::byteSize() const
+{
+    return sizeof(DisconnectCommand);
+}
+
 //------
 
 ConnectCommand::ConnectCommand(BasicGraphicsScene *scene, ConnectionId const connId)
@@ -406,11 +512,17 @@ void ConnectCommand::redo()
     _scene->graphModel().addConnection(_connId);
 }
 
+std::size_t ConnectCommand::byteSize() const
+{
+    return sizeof(ConnectCommand);
+}
+
 //------
 
 MoveNodeCommand::MoveNodeCommand(BasicGraphicsScene *scene, QPointF const &diff)
     : _scene(scene)
     , _diff(diff)
+    , _mergeable(true)
 {
     _selectedNodes.clear();
     for (QGraphicsItem *item : _scene->selectedItems()) {
@@ -420,6 +532,15 @@ MoveNodeCommand::MoveNodeCommand(BasicGraphicsScene *scene, QPointF const &diff)
     }
 }
 
+MoveNodeCommand::MoveNodeCommand(BasicGraphicsScene *scene,
+                                 std::unordered_set<NodeId> nodeIds,
+                                 QPointF const &diff)
+    : _scene(scene)
+    , _selectedNodes(std::move(nodeIds))
+    , _diff(diff)
+    , _mergeable(false)
+{}
+
 void MoveNodeCommand::undo()
 {
     for (auto nodeId : _selectedNodes) {
@@ -444,6 +565,9 @@ void MoveNodeCommand::redo()
 
 int MoveNodeCommand::id() const
 {
+    if (!_mergeable)
+        return -1;
+
     return static_cast<int>(typeid(MoveNodeCommand).hash_code());
 }
 
@@ -458,4 +582,11 @@ bool MoveNodeCommand::mergeWith(QUndoCommand const *c)
     return false;
 }
 
+std::size_t MoveNodeCommand::byteSize() const
+{
+    // One hash node per id plus the bucket array.
+    return sizeof(MoveNodeCommand) + _selectedNodes.size() * (sizeof(NodeId) + 2 * sizeof(void *))
+           + _selectedNodes.bucket_count() * sizeof(void *);
+}
+
 } // namespace QtNodes
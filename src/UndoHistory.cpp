@@ -0,0 +1,148 @@
+#include "UndoHistory.hpp"
+
+#include "UndoCommands.hpp"
+
+#include <QAction>
+#include <QUndoStack>
+
+#include <vector>
+
+namespace QtNodes {
+
+namespace {
+
+/// Rough footprint of a QUndoCommand and its private data.
+std::size_t const UnsizedCommandCost = 128;
+
+} // namespace
+
+UndoHistory::UndoHistory(QUndoStack &undoStack, QObject *parent)
+    : QObject(parent)
+    , _undoStack(undoStack)
+{
+    // Emitted on push, undo, redo and clear, also when a push was merged.
+    connect(&_undoStack, &QUndoStack::indexChanged, this, [this](int) { update(); });
+}
+
+void UndoHistory::setMemoryLimit(std::size_t const bytes)
+{
+    _memoryLimit = bytes;
+
+    update();
+}
+
+bool UndoHistory::canUndo() const
+{
+    return _undoStack.index() > _undoBoundary;
+}
+
+QAction *UndoHistory::createUndoAction(QObject *parent, QString const &prefix)
+{
+    auto action = new QAction(parent);
+
+    auto updateText = [action, prefix](QString const &text) {
+        QString label = prefix.isEmpty() ? tr("Undo") : prefix;
+
+        if (!text.isEmpty())
+            label += QLatin1Char(' ') + text;
+
+        action->setText(label);
+    };
+
+    updateText(_undoStack.undoText());
+    action->setEnabled(canUndo());
+
+    connect(&_undoStack, &QUndoStack::undoTextChanged, action, updateText);
+    connect(this, &UndoHistory::canUndoChanged, action, &QAction::setEnabled);
+    connect(action, &QAction::triggered, this, &UndoHistory::undo);
+
+    return action;
+}
+
+void UndoHistory::undo()
+{
+    if (canUndo())
+        _undoStack.undo();
+}
+
+std::size_t UndoHistory::commandSize(QUndoCommand const *command)
+{
+    auto sized = dynamic_cast<SizedUndoCommand const *>(command);
+
+    std::size_t size = sized ? sized->byteSize() : UnsizedCommandCost;
+
+    // Macros keep their commands as children.
+    for (int i = 0; i < command->childCount(); ++i)
+        size += commandSize(command->child(i));
+
+    return size;
+}
+
+void UndoHistory::releaseState(QUndoCommand *command)
+{
+    if (auto sized = dynamic_cast<SizedUndoCommand *>(command))
+        sized->releaseState();
+
+    for (int i = 0; i < command->childCount(); ++i)
+        releaseState(const_cast<QUndoCommand *>(command->child(i)));
+}
+
+void UndoHistory::update()
+{
+    int const count = _undoStack.count();
+
+    std::vector<std::size_t> sizes(static_cast<std::size_t>(count), 0);
+
+    std::size_t usage = 0;
+
+    for (int i = 0; i < count; ++i) {
+        QUndoCommand const *command = _undoStack.command(i);
+
+        // Evicted commands wait on the stack until undo reaches them.
+        if (command->isObsolete())
+            continue;
+
+        sizes[i] = commandSize(command);
+        usage += sizes[i];
+    }
+
+    if (_memoryLimit > 0) {
+        // Only commands below the current index are evicted, the oldest first,
+        // so the evicted ones always form the bottom of the stack.
+        int const lastEvictable = _undoStack.index() - 1;
+
+        for (int i = 0; i < lastEvictable && usage > _memoryLimit; ++i) {
+            auto command = const_cast<QUndoCommand *>(_undoStack.command(i));
+
+            if (command->isObsolete())
+                continue;
+
+            releaseState(command);
+            command->setObsolete(true);
+
+            usage -= sizes[i];
+            ++_evictedCount;
+        }
+    }
+
+    // Undoing one of the evicted commands would only drop it.
+    int boundary = 0;
+    while (boundary < count && _undoStack.command(boundary)->isObsolete())
+        ++boundary;
+
+    _undoBoundary = boundary;
+
+    if (canUndo() != _canUndo) {
+        _canUndo = canUndo();
+
+        Q_EMIT canUndoChanged(_canUndo);
+    }
+
+    if (usage != _memoryUsage) {
+        _memoryUsage = usage;
+
+        Q_EMIT memoryUsageChanged(_memoryUsage);
+    }
+}
+
+} // namespace QtNodes
@@ -1,6 +1,7 @@
 #include "locateNode.hpp"
 
 
+#include "BasicGraphicsScene.hpp"
 #include "NodeGraphicsObject.hpp"
 
 #include <QtCore/QList>
@@ -13,6 +14,25 @@ NodeGraphicsObject *locateNodeAt(QPointF scenePoint,
                                  QGraphicsScene &scene,
                                  QTransform const &viewTransform)
 {
+    // Only the nodes around the point are tested.
+    if (auto nodeScene = dynamic_cast<BasicGraphicsScene *>(&scene)) {
+        NodeGraphicsObject *node = nullptr;
+
+        for (NodeId const nodeId : nodeScene->spatialIndex().nodesAt(scenePoint)) {
+            NodeGraphicsObject *ngo = nodeScene->nodeGraphicsObject(nodeId);
+
+            if (!ngo || !ngo->isVisible() || !ngo->contains(ngo->mapFromScene(scenePoint)))
+                continue;
+
+            // The topmost node wins, ties go to the most recent one.
+            if (!node || ngo->zValue() > node->zValue()
+                || (ngo->zValue() == node->zValue() && nodeId > node->nodeId()))
+                node = ngo;
+        }
+
+        return node;
+    }
+
     // items under cursor
     QList<QGraphicsItem *> items = scene.items(scenePoint,
                                                Qt::IntersectsItemShape,
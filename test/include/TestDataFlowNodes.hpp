@@ -6,8 +6,11 @@
 #include <QLineEdit>
 #include <QLabel>
 #include <QString>
+#include <QThread>
 
+#include <atomic>
 #include <memory>
+#include <stdexcept>
 
 
 using QtNodes::NodeData;
@@ -28,6 +31,8 @@ public:
         return NodeDataType{"TestData", "Test Data"};
     }
 
+    std::size_t byteSize() const override { return _text.size() * sizeof(QChar); }
+
     QString text() const { return _text; }
     void setText(const QString& text) { _text = text; }
 
@@ -153,3 +158,216 @@ private:
     QLabel* _label;
     std::shared_ptr<TestData> _receivedData;
 };
+
+
+// Node with two inputs that counts how often it receives data
+class TestMergeNode : public NodeDelegateModel
+{
+    Q_OBJECT
+
+public:
+    QString caption() const override { return "Test Merge"; }
+    QString name() const override { return "TestMergeNode"; }
+    static QString Name() { return "TestMergeNode"; }
+
+    unsigned int nPorts(PortType portType) const override
+    {
+        return (portType == PortType::In) ? 2 : 1;
+    }
+
+    NodeDataType dataType(PortType portType, PortIndex portIndex) const override
+    {
+        Q_UNUSED(portType);
+        Q_UNUSED(portIndex);
+        return TestData{}.type();
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const portIndex) override
+    {
+        Q_UNUSED(portIndex);
+        return _result;
+    }
+
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const portIndex) override
+    {
+        _inputs[portIndex] = std::dynamic_pointer_cast<TestData>(data);
+        ++_inputCount;
+
+        QString text;
+        for (auto const &input : _inputs) {
+            if (input)
+                text += input->text();
+        }
+        _result = std::make_shared<TestData>(text);
+
+        Q_EMIT dataUpdated(0);
+    }
+
+    QWidget* embeddedWidget() override { return nullptr; }
+
+    int inputCount() const { return _inputCount; }
+
+    QString getText() const { return _result ? _result->text() : QString(); }
+
+private:
+    std::shared_ptr<TestData> _inputs[2];
+    std::shared_ptr<TestData> _result;
+    int _inputCount = 0;
+};
+
+
+// Widget-less pass-through node that may be evaluated on a worker thread
+class TestThreadSafeNode : public NodeDelegateModel
+{
+    Q_OBJECT
+
+public:
+    QString caption() const override { return "Test Thread Safe"; }
+    QString name() const override { return "TestThreadSafeNode"; }
+    static QString Name() { return "TestThreadSafeNode"; }
+
+    bool threadSafeCompute() const override { return true; }
+
+    unsigned int nPorts(PortType portType) const override
+    {
+        Q_UNUSED(portType);
+        return 1;
+    }
+
+    NodeDataType dataType(PortType portType, PortIndex portIndex) const override
+    {
+        Q_UNUSED(portType);
+        Q_UNUSED(portIndex);
+        return TestData{}.type();
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const portIndex) override
+    {
+        Q_UNUSED(portIndex);
+        return _result;
+    }
+
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const portIndex) override
+    {
+        Q_UNUSED(portIndex);
+        _computeThread = QThread::currentThread();
+
+        if (_delayMs > 0)
+            QThread::msleep(_delayMs);
+
+        auto d = std::dynamic_pointer_cast<TestData>(data);
+        _result = d ? std::make_shared<TestData>(d->text().toUpper()) : nullptr;
+
+        Q_EMIT dataUpdated(0);
+    }
+
+    QWidget* embeddedWidget() override { return nullptr; }
+
+    QThread* computeThread() const { return _computeThread; }
+
+    /// Keeps setInData() busy so that the evaluation is still in flight.
+    void setDelay(unsigned long ms) { _delayMs = ms; }
+
+    QString getText() const { return _result ? _result->text() : QString(); }
+
+private:
+    std::shared_ptr<TestData> _result;
+    std::atomic<QThread*> _computeThread{nullptr};
+    unsigned long _delayMs = 0;
+};
+
+
+// Node whose setInData() throws for the input "throw"
+class TestThrowingNode : public NodeDelegateModel
+{
+    Q_OBJECT
+
+public:
+    QString caption() const override { return "Test Throwing"; }
+    QString name() const override { return "TestThrowingNode"; }
+    static QString Name() { return "TestThrowingNode"; }
+
+    unsigned int nPorts(PortType portType) const override
+    {
+        return (portType == PortType::In) ? 1 : 0;
+    }
+
+    NodeDataType dataType(PortType portType, PortIndex portIndex) const override
+    {
+        Q_UNUSED(portType);
+        Q_UNUSED(portIndex);
+        return TestData{}.type();
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const) override { return nullptr; }
+
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const) override
+    {
+        auto d = std::dynamic_pointer_cast<TestData>(data);
+        if (d && d->text() == "throw")
+            throw std::runtime_error("throw");
+    }
+
+    QWidget* embeddedWidget() override { return nullptr; }
+};
+
+
+// Node computing its output asynchronously; the input "fail" makes it fail
+class TestAsyncNode : public NodeDelegateModel
+{
+    Q_OBJECT
+
+public:
+    QString caption() const override { return "Test Async"; }
+    QString name() const override { return "TestAsyncNode"; }
+    static QString Name() { return "TestAsyncNode"; }
+
+    unsigned int nPorts(PortType portType) const override
+    {
+        Q_UNUSED(portType);
+        return 1;
+    }
+
+    NodeDataType dataType(PortType portType, PortIndex portIndex) const override
+    {
+        Q_UNUSED(portType);
+        Q_UNUSED(portIndex);
+        return TestData{}.type();
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex const portIndex) override
+    {
+        Q_UNUSED(portIndex);
+        return _result;
+    }
+
+    void setInData(std::shared_ptr<NodeData> data, PortIndex const portIndex) override
+    {
+        Q_UNUSED(portIndex);
+        auto d = std::dynamic_pointer_cast<TestData>(data);
+        QString const text = d ? d->text() : QString();
+
+        startCompute(
+            [text](QtNodes::ComputeTask const &) {
+                QThread::msleep(20);
+                if (text == "fail")
+                    throw std::runtime_error("fail");
+                return std::make_shared<TestData>(text + "!");
+            },
+            [this](std::shared_ptr<TestData> const &result) {
+                _result = result;
+                ++_publishCount;
+                Q_EMIT dataUpdated(0);
+            });
+    }
+
+    QWidget* embeddedWidget() override { return nullptr; }
+
+    int publishCount() const { return _publishCount; }
+
+    QString getText() const { return _result ? _result->text() : QString(); }
+
+private:
+    std::shared_ptr<TestData> _result;
+    int _publishCount = 0;
+};
@@ -281,3 +281,66 @@ TEST_CASE("AbstractGraphModel edge case signal emissions", "[signals]")
         CHECK(model.allNodeIds().count(nodeId) == 0);
     }
 }
+
+TEST_CASE("AbstractGraphModel batched changes", "[signals]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+
+    NodeId existing = model.addNode("Existing");
+
+    std::vector<QtNodes::GraphChangeDelta> deltas;
+    QObject::connect(&model,
+                     &TestGraphModel::graphChanged,
+                     [&deltas](QtNodes::GraphChangeDelta const &delta) { deltas.push_back(delta); });
+
+    SECTION("Outermost batch reports the net delta once")
+    {
+        NodeId created;
+        ConnectionId connId;
+        {
+            QtNodes::GraphChangeBatch outer(model);
+            model.beginBatch();
+
+            created = model.addNode("Created");
+            NodeId transient = model.addNode("Transient");
+
+            connId = ConnectionId{existing, 0, created, 0};
+            model.addConnection(connId);
+            model.addConnection(ConnectionId{created, 0, transient, 0});
+
+            model.deleteNode(transient);
+
+            model.endBatch();
+            CHECK(model.batchInProgress());
+            CHECK(deltas.empty());
+        }
+
+        CHECK_FALSE(model.batchInProgress());
+        REQUIRE(deltas.size() == 1);
+
+        auto const &delta = deltas.front();
+        CHECK(delta.createdNodes == std::unordered_set<NodeId>{created});
+        CHECK(delta.deletedNodes.empty());
+        CHECK(delta.createdConnections == std::unordered_set<ConnectionId>{connId});
+        CHECK(delta.deletedConnections.empty());
+    }
+
+    SECTION("Deleted items are reported")
+    {
+        model.beginBatch();
+        model.deleteNode(existing);
+        model.endBatch();
+
+        REQUIRE(deltas.size() == 1);
+        CHECK(deltas.front().deletedNodes == std::unordered_set<NodeId>{existing});
+    }
+
+    SECTION("Batches without changes are not reported")
+    {
+        model.beginBatch();
+        model.endBatch();
+
+        CHECK(deltas.empty());
+    }
+}
@@ -0,0 +1,314 @@
+#include "ApplicationSetup.hpp"
+#include "TestDataFlowNodes.hpp"
+
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/ExecutionPlan>
+#include <QtNodes/NodeDelegateModelRegistry>
+#include <QtNodes/NodeProfiler>
+
+#include <catch2/catch.hpp>
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QTest>
+#include <QThread>
+#include <QThreadPool>
+
+#include <memory>
+#include <vector>
+
+using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeProcessingStatus;
+
+namespace {
+
+bool waitForStatus(NodeDelegateModel const &node, NodeProcessingStatus status)
+{
+    for (int i = 0; i < 200 && node.processingStatus() != status; ++i) {
+        QTest::qWait(10);
+    }
+
+    return node.processingStatus() == status;
+}
+
+/// Keeps a pool thread busy until the semaphore is released.
+class BlockingRunnable : public QRunnable
+{
+public:
+    explicit BlockingRunnable(QSemaphore &release)
+        : _release(release)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override { _release.acquire(); }
+
+private:
+    QSemaphore &_release;
+};
+
+} // namespace
+
+TEST_CASE("Asynchronous compute", "[async]")
+{
+    auto app = applicationSetup();
+
+    SECTION("Only the latest generation is published")
+    {
+        TestAsyncNode node;
+
+        node.setInData(std::make_shared<TestData>("first"), 0);
+        auto const firstTask = node.currentCompute();
+
+        node.setInData(std::make_shared<TestData>("second"), 0);
+        auto const secondTask = node.currentCompute();
+
+        CHECK(firstTask.isCancelled());
+        CHECK(secondTask.generation() > firstTask.generation());
+        CHECK(node.processingStatus() != NodeProcessingStatus::Updated);
+
+        REQUIRE(waitForStatus(node, NodeProcessingStatus::Updated));
+
+        CHECK(node.publishCount() == 1);
+        CHECK(node.getText() == "second!");
+    }
+
+    SECTION("Started and finished signals pair up")
+    {
+        TestAsyncNode node;
+
+        QSignalSpy started(&node, &NodeDelegateModel::computingStarted);
+        QSignalSpy finished(&node, &NodeDelegateModel::computingFinished);
+
+        node.setInData(std::make_shared<TestData>("a"), 0);
+        node.setInData(std::make_shared<TestData>("b"), 0);
+        node.setInData(std::make_shared<TestData>("c"), 0);
+
+        REQUIRE(waitForStatus(node, NodeProcessingStatus::Updated));
+
+        CHECK(started.count() == 1);
+        CHECK(finished.count() == 1);
+
+        node.setInData(std::make_shared<TestData>("d"), 0);
+        node.cancelCompute();
+
+        CHECK(started.count() == 2);
+        CHECK(finished.count() == 2);
+    }
+
+    SECTION("Inputs delivered by the model supersede the running compute")
+    {
+        auto registry = std::make_shared<NodeDelegateModelRegistry>();
+        registry->registerModel<TestSourceNode>();
+        registry->registerModel<TestAsyncNode>();
+
+        DataFlowGraphModel model(registry);
+
+        auto sourceId = model.addNode("TestSourceNode");
+        auto asyncId = model.addNode("TestAsyncNode");
+
+        model.addConnection(ConnectionId{sourceId, 0, asyncId, 0});
+
+        auto source = model.delegateModel<TestSourceNode>(sourceId);
+        auto async = model.delegateModel<TestAsyncNode>(asyncId);
+
+        REQUIRE(waitForStatus(*async, NodeProcessingStatus::Updated));
+
+        QSignalSpy started(async, &NodeDelegateModel::computingStarted);
+        QSignalSpy finished(async, &NodeDelegateModel::computingFinished);
+
+        source->setText("a");
+        auto const firstTask = async->currentCompute();
+
+        source->setText("b");
+
+        CHECK(firstTask.isCancelled());
+        CHECK(started.count() == 1);
+        CHECK(finished.count() == 0);
+
+        REQUIRE(waitForStatus(*async, NodeProcessingStatus::Updated));
+
+        CHECK(started.count() == 1);
+        CHECK(finished.count() == 1);
+        CHECK(async->getText() == "b!");
+    }
+
+    SECTION("Deleting a node does not wait for its queued runs")
+    {
+        QThreadPool *pool = QThreadPool::globalInstance();
+        int const maxThreads = pool->maxThreadCount();
+        pool->setMaxThreadCount(1);
+
+        // Occupies the only pool thread until released.
+        QSemaphore release;
+        BlockingRunnable blocker(release);
+        pool->start(&blocker);
+
+        auto node = std::make_unique<TestAsyncNode>();
+        node->setInData(std::make_shared<TestData>("queued"), 0);
+        auto const task = node->currentCompute();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        node.reset();
+
+        CHECK(timer.elapsed() < 1000);
+        CHECK(task.isCancelled());
+
+        release.release();
+        pool->waitForDone();
+        pool->setMaxThreadCount(maxThreads);
+
+        CHECK(task.isFinished());
+    }
+
+    SECTION("Exceptions mark the node as failed")
+    {
+        TestAsyncNode node;
+
+        node.setInData(std::make_shared<TestData>("fail"), 0);
+
+        REQUIRE(waitForStatus(node, NodeProcessingStatus::Failed));
+        CHECK(node.publishCount() == 0);
+    }
+
+    SECTION("Cancelled computation is dropped")
+    {
+        TestAsyncNode node;
+
+        node.setInData(std::make_shared<TestData>("dropped"), 0);
+        node.cancelCompute();
+
+        CHECK(node.processingStatus() == NodeProcessingStatus::Pending);
+
+        QTest::qWait(100);
+        CHECK(node.publishCount() == 0);
+    }
+
+    SECTION("Published results propagate downstream")
+    {
+        auto registry = std::make_shared<NodeDelegateModelRegistry>();
+        registry->registerModel<TestSourceNode>();
+        registry->registerModel<TestAsyncNode>();
+        registry->registerModel<TestDisplayNode>();
+
+        DataFlowGraphModel model(registry);
+
+        auto sourceId = model.addNode("TestSourceNode");
+        auto asyncId = model.addNode("TestAsyncNode");
+        auto displayId = model.addNode("TestDisplayNode");
+
+        model.addConnection(ConnectionId{sourceId, 0, asyncId, 0});
+        model.addConnection(ConnectionId{asyncId, 0, displayId, 0});
+
+        auto source = model.delegateModel<TestSourceNode>(sourceId);
+        auto async = model.delegateModel<TestAsyncNode>(asyncId);
+        auto display = model.delegateModel<TestDisplayNode>(displayId);
+
+        source->setText("x");
+
+        REQUIRE(waitForStatus(*async, NodeProcessingStatus::Updated));
+        CHECK(display->getText() == "x!");
+    }
+
+    SECTION("Compiled runs stop at asynchronous nodes")
+    {
+        auto registry = std::make_shared<NodeDelegateModelRegistry>();
+        registry->registerModel<TestSourceNode>();
+        registry->registerModel<TestAsyncNode>();
+        registry->registerModel<TestDisplayNode>();
+
+        DataFlowGraphModel model(registry);
+
+        auto sourceId = model.addNode("TestSourceNode");
+        auto asyncId = model.addNode("TestAsyncNode");
+        auto displayId = model.addNode("TestDisplayNode");
+
+        model.addConnection(ConnectionId{sourceId, 0, asyncId, 0});
+        model.addConnection(ConnectionId{asyncId, 0, displayId, 0});
+
+        auto async = model.delegateModel<TestAsyncNode>(asyncId);
+        auto display = model.delegateModel<TestDisplayNode>(displayId);
+
+        REQUIRE(waitForStatus(*async, NodeProcessingStatus::Updated));
+
+        QtNodes::ExecutionPlan plan = model.compile();
+        plan.setSourceData(sourceId, 0, std::make_shared<TestData>("p"));
+
+        CHECK_FALSE(plan.run());
+        CHECK(plan.pendingNodeId() == asyncId);
+
+        // The previous result of the async node was not passed on.
+        CHECK(plan.outData(asyncId, 0) == nullptr);
+        CHECK(plan.outData(displayId, 0) == nullptr);
+
+        REQUIRE(waitForStatus(*async, NodeProcessingStatus::Updated));
+        CHECK(display->getText() == "p!");
+    }
+
+    SECTION("The profiler times the asynchronous run")
+    {
+        auto registry = std::make_shared<NodeDelegateModelRegistry>();
+        registry->registerModel<TestSourceNode>();
+        registry->registerModel<TestAsyncNode>();
+
+        DataFlowGraphModel model(registry);
+
+        auto sourceId = model.addNode("TestSourceNode");
+        auto asyncId = model.addNode("TestAsyncNode");
+
+        model.addConnection(ConnectionId{sourceId, 0, asyncId, 0});
+
+        auto source = model.delegateModel<TestSourceNode>(sourceId);
+        auto async = model.delegateModel<TestAsyncNode>(asyncId);
+
+        // The connection delivers the initial text first.
+        REQUIRE(waitForStatus(*async, NodeProcessingStatus::Updated));
+
+        model.profiler().setEnabled(true);
+        source->setText("x");
+
+        // The result is delivered late while the model thread is busy.
+        QThread::msleep(100);
+
+        REQUIRE(waitForStatus(*async, NodeProcessingStatus::Updated));
+
+        // TestAsyncNode sleeps for 20 ms in its work function.
+        auto const stats = model.profiler().stats(asyncId);
+        CHECK(stats.invocations == 1);
+        CHECK(stats.totalNs >= 20 * 1000 * 1000);
+        CHECK(stats.lastCause == sourceId);
+
+        std::vector<QtNodes::NodeProfiler::Event> invocations;
+        std::vector<QtNodes::NodeProfiler::Event> computes;
+        for (auto const &e : model.profiler().events()) {
+            if (e.nodeId == asyncId)
+                (e.compute ? computes : invocations).push_back(e);
+        }
+
+        REQUIRE(invocations.size() == 1);
+        REQUIRE(computes.size() == 1);
+
+        // The run is placed where it ran, on its worker thread.
+        auto const &compute = computes.front();
+        CHECK(compute.startNs >= invocations.front().startNs);
+        CHECK(compute.startNs - invocations.front().startNs < 50 * 1000 * 1000);
+        CHECK(compute.thread != invocations.front().thread);
+        CHECK(compute.generation > 0);
+
+        QJsonArray const traceEvents = model.profileTrace()["traceEvents"].toArray();
+        for (auto const &value : traceEvents) {
+            QJsonObject const event = value.toObject();
+            if (event["ph"].toString() == "b")
+                CHECK(event["id"].toString()
+                      == QString("%1.%2").arg(asyncId).arg(compute.generation));
+        }
+    }
+}
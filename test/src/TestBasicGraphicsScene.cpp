@@ -2,10 +2,13 @@
 #include "TestGraphModel.hpp"
 
 #include <QtNodes/BasicGraphicsScene>
+#include <QtNodes/GraphicsView>
 
 #include <catch2/catch.hpp>
 
 #include <QGraphicsView>
+#include <QSignalBlocker>
+#include <QTest>
 #include <QUndoStack>
 
 using QtNodes::BasicGraphicsScene;
@@ -119,3 +122,212 @@ TEST_CASE("BasicGraphicsScene undo/redo support", "[graphics]")
         CHECK(undoStack.count() >= 0);
     }
 }
+
+TEST_CASE("BasicGraphicsScene suspended updates", "[graphics]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    int modifiedCount = 0;
+    QObject::connect(&scene, &BasicGraphicsScene::modified, [&modifiedCount]() {
+        ++modifiedCount;
+    });
+
+    scene.suspendUpdates();
+    scene.suspendUpdates();
+    CHECK(scene.updatesSuspended());
+
+    NodeId node1 = model.addNode("Node1");
+    NodeId node2 = model.addNode("Node2");
+    NodeId removed = model.addNode("Removed");
+
+    ConnectionId connId{node1, 0, node2, 0};
+    model.addConnection(connId);
+    model.addConnection(ConnectionId{node2, 0, removed, 0});
+
+    model.deleteNode(removed);
+
+    CHECK(scene.nodeGraphicsObject(node1) == nullptr);
+    CHECK(scene.connectionGraphicsObject(connId) == nullptr);
+
+    // Only the outermost call builds the graphics objects.
+    scene.resumeUpdates();
+    CHECK(scene.updatesSuspended());
+    CHECK(scene.nodeGraphicsObject(node1) == nullptr);
+
+    scene.resumeUpdates();
+    CHECK_FALSE(scene.updatesSuspended());
+
+    CHECK(scene.nodeGraphicsObject(node1) != nullptr);
+    CHECK(scene.nodeGraphicsObject(node2) != nullptr);
+    CHECK(scene.nodeGraphicsObject(removed) == nullptr);
+    CHECK(scene.connectionGraphicsObject(connId) != nullptr);
+    CHECK(modifiedCount == 1);
+}
+
+TEST_CASE("BasicGraphicsScene applies batched changes", "[graphics]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    NodeId existing = model.addNode("Existing");
+
+    int modifiedCount = 0;
+    QObject::connect(&scene, &BasicGraphicsScene::modified, [&modifiedCount]() {
+        ++modifiedCount;
+    });
+
+    NodeId created;
+    ConnectionId connId;
+    {
+        QtNodes::GraphChangeBatch batch(model);
+
+        created = model.addNode("Created");
+        connId = ConnectionId{existing, 0, created, 0};
+        model.addConnection(connId);
+
+        // Graphics objects are built when the batch ends.
+        CHECK(scene.nodeGraphicsObject(created) == nullptr);
+        CHECK(scene.connectionGraphicsObject(connId) == nullptr);
+    }
+
+    CHECK(scene.nodeGraphicsObject(created) != nullptr);
+    CHECK(scene.connectionGraphicsObject(connId) != nullptr);
+    CHECK(modifiedCount == 1);
+
+    {
+        QtNodes::GraphChangeBatch batch(model);
+        model.deleteNode(created);
+
+        CHECK(scene.nodeGraphicsObject(created) == nullptr);
+    }
+
+    CHECK(scene.connectionGraphicsObject(connId) == nullptr);
+    CHECK(modifiedCount == 2);
+}
+
+TEST_CASE("BasicGraphicsScene re-measures updated nodes", "[graphics]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    NodeId nodeId = model.addNode("TestNode");
+
+    auto &geometry = scene.nodeGeometry();
+
+    QRectF const shortCaption = geometry.captionRect(nodeId);
+
+    model.setNodeData(nodeId, NodeRole::Caption, QString("A considerably longer caption"));
+
+    QRectF const longCaption = geometry.captionRect(nodeId);
+
+    CHECK(longCaption.width() > shortCaption.width());
+    CHECK(geometry.size(nodeId).width() >= longCaption.width());
+}
+
+namespace {
+
+/// Labels its ports, the third input with a long caption.
+class CaptionedPortsModel : public TestGraphModel
+{
+public:
+    QVariant portData(NodeId nodeId,
+                      QtNodes::PortType portType,
+                      QtNodes::PortIndex portIndex,
+                      QtNodes::PortRole role) const override
+    {
+        switch (role) {
+        case QtNodes::PortRole::CaptionVisible:
+            return true;
+
+        case QtNodes::PortRole::Caption:
+            return portIndex == 2 ? QString("A considerably longer port caption")
+                                  : QString("in");
+
+        default:
+            return TestGraphModel::portData(nodeId, portType, portIndex, role);
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("BasicGraphicsScene re-measures nodes whose port count changed", "[graphics]")
+{
+    auto app = applicationSetup();
+    CaptionedPortsModel model;
+    BasicGraphicsScene scene(model);
+
+    NodeId nodeId = model.addNode("TestNode");
+
+    auto &geometry = scene.nodeGeometry();
+
+    geometry.recomputeSize(nodeId);
+    int const narrowWidth = geometry.size(nodeId).width();
+
+    {
+        // The ports change without a nodeUpdated notification.
+        QSignalBlocker blocker(model);
+        model.setNodeData(nodeId, NodeRole::InPortCount, 3u);
+    }
+
+    geometry.recomputeSize(nodeId);
+
+    // Only a rebuilt measurement knows the long caption of the new port.
+    CHECK(geometry.size(nodeId).width() > narrowWidth);
+    CHECK(geometry.boundingRect(nodeId).width() > narrowWidth);
+}
+
+TEST_CASE("BasicGraphicsScene render diagnostics", "[graphics]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    NodeId node1 = model.addNode("Node1");
+    NodeId node2 = model.addNode("Node2");
+    model.setNodeData(node1, NodeRole::Position, QPointF(-150, 0));
+    model.setNodeData(node2, NodeRole::Position, QPointF(150, 0));
+    model.addConnection(ConnectionId{node1, 0, node2, 0});
+
+    QtNodes::GraphicsView view(&scene);
+    view.resize(800, 600);
+    view.show();
+    REQUIRE(QTest::qWaitForWindowExposed(&view));
+
+    auto &diagnostics = scene.renderDiagnostics();
+    CHECK_FALSE(diagnostics.isEnabled());
+
+    diagnostics.setEnabled(true);
+    diagnostics.reset();
+
+    view.viewport()->repaint();
+
+    REQUIRE(diagnostics.frameCount() == 1);
+    CHECK(diagnostics.lastFrame().connectionPaints >= 1);
+    CHECK(diagnostics.lastFrame().updatePixels > 0);
+    CHECK(diagnostics.lastFrame().cacheHits + diagnostics.lastFrame().cacheMisses == 2);
+
+    SECTION("Unchanged nodes are drawn from their caches")
+    {
+        view.viewport()->repaint();
+
+        CHECK(diagnostics.lastFrame().nodePaints == 0);
+        CHECK(diagnostics.lastFrame().cacheHits == 2);
+        CHECK(diagnostics.totals().connectionPaints >= 2);
+    }
+
+    SECTION("The overlay keeps recording enabled")
+    {
+        diagnostics.setEnabled(false);
+
+        view.setRenderDiagnosticsOverlayEnabled(true);
+        CHECK(diagnostics.isEnabled());
+
+        view.viewport()->repaint();
+        CHECK(diagnostics.frameCount() == 2);
+    }
+}
@@ -8,6 +8,7 @@
 #include <QtNodes/internal/AbstractNodePainter.hpp>
 #include <QtNodes/internal/BasicGraphicsScene.hpp>
 #include <QtNodes/internal/ConnectionGraphicsObject.hpp>
+#include <QtNodes/internal/ConnectionStyle.hpp>
 #include <QtNodes/internal/GraphicsView.hpp>
 #include <QtNodes/internal/NodeGraphicsObject.hpp>
 
@@ -49,6 +50,7 @@ class TestConnectionPainter : public AbstractConnectionPainter
 {
 public:
     mutable int paintCallCount = 0;
+    mutable int strokeCallCount = 0;
 
     void paint(QPainter *painter, ConnectionGraphicsObject const &cgo) const override
     {
@@ -61,6 +63,8 @@ public:
 
     QPainterPath getPainterStroke(ConnectionGraphicsObject const &cgo) const override
     {
+        strokeCallCount++;
+
         QPainterPath path;
         path.moveTo(cgo.endPoint(QtNodes::PortType::Out));
         path.lineTo(cgo.endPoint(QtNodes::PortType::In));
@@ -178,3 +182,132 @@ TEST_CASE("Custom painter with scene operations", "[painters]")
         CHECK(&scene.nodePainter() == nodePainterPtr);
     }
 }
+
+TEST_CASE("Node style is cached for painting", "[painters]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    auto styleWith = [](QColor const &color) {
+        QtNodes::NodeStyle style;
+        style.NormalBoundaryColor = color;
+        return QVariant(style.toJson().toVariantMap());
+    };
+
+    NodeId nodeId = model.addNode("TestNode");
+    model.setNodeData(nodeId, NodeRole::Style, styleWith(Qt::red));
+
+    NodeGraphicsObject *ngo = scene.nodeGraphicsObject(nodeId);
+    REQUIRE(ngo != nullptr);
+
+    // The model keeps no NodeStyle instances, the JSON is parsed once.
+    CHECK(model.nodeStyle(nodeId) == nullptr);
+
+    QtNodes::NodeStyle const &style = ngo->nodeStyle();
+    CHECK(style.NormalBoundaryColor == QColor(Qt::red));
+    CHECK(&ngo->nodeStyle() == &style);
+
+    // Without nodeUpdated the cached style is kept.
+    model.setNodeData(nodeId, NodeRole::Style, styleWith(Qt::green));
+    CHECK(ngo->nodeStyle().NormalBoundaryColor == QColor(Qt::red));
+
+    // TestGraphModel emits nodeUpdated for caption changes.
+    model.setNodeData(nodeId, NodeRole::Caption, QString("Renamed"));
+    CHECK(ngo->nodeStyle().NormalBoundaryColor == QColor(Qt::green));
+}
+
+TEST_CASE("Connection geometry is cached", "[painters]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    auto customConnectionPainter = std::make_unique<TestConnectionPainter>();
+    TestConnectionPainter *connectionPainterPtr = customConnectionPainter.get();
+    scene.setConnectionPainter(std::move(customConnectionPainter));
+
+    NodeId node1 = model.addNode("TestNode1");
+    NodeId node2 = model.addNode("TestNode2");
+    model.setNodeData(node1, NodeRole::Position, QPointF(0, 0));
+    model.setNodeData(node2, NodeRole::Position, QPointF(300, 100));
+
+    ConnectionId connId{node1, 0, node2, 0};
+    model.addConnection(connId);
+
+    ConnectionGraphicsObject *cgo = scene.connectionGraphicsObject(connId);
+    REQUIRE(cgo != nullptr);
+
+    QPainterPath const path = cgo->cubicPath();
+    QRectF const rect = cgo->boundingRect();
+
+    CHECK(path.pointAtPercent(0.0) == cgo->out());
+    CHECK(path.pointAtPercent(1.0) == cgo->in());
+    CHECK(rect.contains(path.boundingRect()));
+
+    cgo->shape();
+    int const strokes = connectionPainterPtr->strokeCallCount;
+
+    SECTION("Repeated queries reuse the stroke")
+    {
+        cgo->shape();
+        cgo->shape();
+        cgo->boundingRect();
+
+        CHECK(connectionPainterPtr->strokeCallCount == strokes);
+    }
+
+    SECTION("Moving an end point rebuilds the geometry")
+    {
+        model.setNodeData(node2, NodeRole::Position, QPointF(500, 300));
+
+        CHECK(cgo->cubicPath() != path);
+        CHECK(cgo->boundingRect() != rect);
+        CHECK(cgo->cubicPath().pointAtPercent(1.0) == cgo->in());
+
+        cgo->shape();
+        CHECK(connectionPainterPtr->strokeCallCount == strokes + 1);
+    }
+
+    SECTION("Replacing the painter rebuilds the stroke")
+    {
+        auto otherPainter = std::make_unique<TestConnectionPainter>();
+        TestConnectionPainter *otherPainterPtr = otherPainter.get();
+        scene.setConnectionPainter(std::move(otherPainter));
+
+        cgo->shape();
+        CHECK(otherPainterPtr->strokeCallCount == 1);
+    }
+}
+
+TEST_CASE("Connection colors per data type", "[painters]")
+{
+    auto app = applicationSetup();
+
+    QtNodes::ConnectionStyle style;
+
+    QColor const derived = style.normalColor("decimal");
+    CHECK(derived.isValid());
+    CHECK(style.normalColor("decimal") == derived);
+    CHECK(QtNodes::ConnectionStyle().normalColor("decimal") == derived);
+
+    SECTION("Overrides win over derived colors")
+    {
+        style.setTypeColor("decimal", Qt::red);
+        CHECK(style.normalColor("decimal") == QColor(Qt::red));
+
+        style.resetTypeColor("decimal");
+        CHECK(style.normalColor("decimal") == derived);
+    }
+
+    SECTION("Overrides are part of the JSON style")
+    {
+        style.setTypeColor("text", QColor("#336699"));
+
+        QtNodes::ConnectionStyle restored;
+        restored.loadJson(style.toJson());
+
+        CHECK(restored.normalColor("text") == QColor("#336699"));
+        CHECK(restored.typeColors().size() == 1);
+    }
+}
@@ -16,6 +16,8 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QMouseEvent>
 #include <QApplication>
+#include <QJsonArray>
+#include <QJsonObject>
 
 using QtNodes::DataFlowGraphicsScene;
 using QtNodes::DataFlowGraphModel;
@@ -29,6 +31,8 @@ std::shared_ptr<NodeDelegateModelRegistry> createTestRegistry()
     auto registry = std::make_shared<NodeDelegateModelRegistry>();
     registry->registerModel<TestSourceNode>();
     registry->registerModel<TestDisplayNode>();
+    registry->registerModel<TestMergeNode>();
+    registry->registerModel<TestThreadSafeNode>();
     return registry;
 }
 
@@ -261,3 +265,339 @@ TEST_CASE("Data Flow - Multiple Connections", "[dataflow][visual]")
         CHECK(display2Model->getText() == "Only Display2"); // Gets new data
     }
 }
+
+TEST_CASE("Data Flow - Scheduled propagation", "[dataflow]")
+{
+    auto app = applicationSetup();
+
+    auto registry = createTestRegistry();
+    DataFlowGraphModel model(registry);
+
+    // source -> left  -> merge -> sink
+    //        -> right -/
+    auto sourceId = model.addNode("TestSourceNode");
+    auto leftId = model.addNode("TestDisplayNode");
+    auto rightId = model.addNode("TestDisplayNode");
+    auto mergeId = model.addNode("TestMergeNode");
+    auto sinkId = model.addNode("TestMergeNode");
+
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, leftId, 0});
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, rightId, 0});
+    model.addConnection(QtNodes::ConnectionId{leftId, 0, mergeId, 0});
+    model.addConnection(QtNodes::ConnectionId{rightId, 0, mergeId, 1});
+    model.addConnection(QtNodes::ConnectionId{mergeId, 0, sinkId, 0});
+
+    auto source = model.delegateModel<TestSourceNode>(sourceId);
+    auto merge = model.delegateModel<TestMergeNode>(mergeId);
+    auto sink = model.delegateModel<TestMergeNode>(sinkId);
+
+    REQUIRE(source != nullptr);
+    REQUIRE(merge != nullptr);
+    REQUIRE(sink != nullptr);
+
+    SECTION("Diamond downstream node is evaluated once per change")
+    {
+        int const mergeBefore = merge->inputCount();
+        int const sinkBefore = sink->inputCount();
+
+        source->setText("ab");
+
+        // One delivery per changed input of the merge node...
+        CHECK(merge->inputCount() - mergeBefore == 2);
+        // ...but its result is pushed downstream only once.
+        CHECK(sink->inputCount() - sinkBefore == 1);
+        CHECK(sink->getText() == "abab");
+    }
+
+    SECTION("Changes inside a transaction are flushed by endUpdate")
+    {
+        int const sinkBefore = sink->inputCount();
+
+        model.beginUpdate();
+        CHECK(model.updateInProgress());
+
+        source->setText("x");
+        source->setText("y");
+
+        CHECK(sink->inputCount() == sinkBefore);
+
+        model.endUpdate();
+        CHECK_FALSE(model.updateInProgress());
+
+        CHECK(sink->inputCount() - sinkBefore == 1);
+        CHECK(sink->getText() == "yy");
+    }
+
+    SECTION("Nodes reordered inside a transaction are evaluated once")
+    {
+        DataFlowGraphModel fresh(registry);
+
+        fresh.beginUpdate();
+
+        // The consumer is created first and ranked before its producer...
+        auto consumerId = fresh.addNode("TestMergeNode");
+        auto producerId = fresh.addNode("TestSourceNode");
+
+        // ...which is queued before the connection reorders them.
+        fresh.delegateModel<TestSourceNode>(producerId)->setText("q");
+
+        fresh.addConnection(QtNodes::ConnectionId{producerId, 0, consumerId, 0});
+
+        fresh.endUpdate();
+
+        auto consumer = fresh.delegateModel<TestMergeNode>(consumerId);
+        CHECK(consumer->inputCount() == 1);
+        CHECK(consumer->getText() == "q");
+    }
+
+    SECTION("A failed load closes its transaction")
+    {
+        QJsonObject position;
+        position["x"] = 0.0;
+        position["y"] = 0.0;
+
+        QJsonObject internalData;
+        internalData["model-name"] = "UnregisteredNode";
+
+        QJsonObject node;
+        node["id"] = 100;
+        node["position"] = position;
+        node["internal-data"] = internalData;
+
+        QJsonObject scene;
+        scene["nodes"] = QJsonArray{node};
+
+        CHECK_THROWS_AS(model.load(scene), std::logic_error);
+        CHECK_FALSE(model.updateInProgress());
+
+        source->setText("z");
+
+        CHECK(sink->getText() == "zz");
+    }
+}
+
+TEST_CASE("Data Flow - Parallel execution mode", "[dataflow]")
+{
+    auto app = applicationSetup();
+
+    auto registry = createTestRegistry();
+    DataFlowGraphModel model(registry);
+
+    CHECK(model.executionMode() == DataFlowGraphModel::ExecutionMode::Sequential);
+    model.setExecutionMode(DataFlowGraphModel::ExecutionMode::Parallel);
+
+    // source -> upperLeft  -> merge
+    //        -> upperRight -/
+    auto sourceId = model.addNode("TestSourceNode");
+    auto leftId = model.addNode("TestThreadSafeNode");
+    auto rightId = model.addNode("TestThreadSafeNode");
+    auto mergeId = model.addNode("TestMergeNode");
+
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, leftId, 0});
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, rightId, 0});
+    model.addConnection(QtNodes::ConnectionId{leftId, 0, mergeId, 0});
+    model.addConnection(QtNodes::ConnectionId{rightId, 0, mergeId, 1});
+
+    auto source = model.delegateModel<TestSourceNode>(sourceId);
+    auto left = model.delegateModel<TestThreadSafeNode>(leftId);
+    auto merge = model.delegateModel<TestMergeNode>(mergeId);
+
+    REQUIRE(source != nullptr);
+    REQUIRE(left != nullptr);
+    REQUIRE(merge != nullptr);
+
+    int const mergeBefore = merge->inputCount();
+
+    source->setText("ab");
+
+    // Thread-safe nodes ran on the pool, results arrived on the model thread.
+    CHECK(left->computeThread() != nullptr);
+    CHECK(left->computeThread() != QThread::currentThread());
+    CHECK(merge->inputCount() - mergeBefore == 2);
+    CHECK(merge->getText() == "ABAB");
+}
+
+TEST_CASE("Data Flow - Failures in a parallel wave", "[dataflow]")
+{
+    auto app = applicationSetup();
+
+    auto registry = createTestRegistry();
+    registry->registerModel<TestThrowingNode>();
+
+    DataFlowGraphModel model(registry);
+    model.setExecutionMode(DataFlowGraphModel::ExecutionMode::Parallel);
+
+    // source -> slow
+    //        -> thrower
+    auto sourceId = model.addNode("TestSourceNode");
+    auto slowId = model.addNode("TestThreadSafeNode");
+    auto throwerId = model.addNode("TestThrowingNode");
+
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, slowId, 0});
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, throwerId, 0});
+
+    auto source = model.delegateModel<TestSourceNode>(sourceId);
+    auto slow = model.delegateModel<TestThreadSafeNode>(slowId);
+
+    REQUIRE(source != nullptr);
+    REQUIRE(slow != nullptr);
+
+    // The thrower fails on the model thread while the slow node is in flight.
+    slow->setDelay(50);
+
+    model.beginUpdate();
+    source->setText("throw");
+
+    CHECK_THROWS_AS(model.endUpdate(), std::runtime_error);
+
+    // The pool task finished before the wave was unwound.
+    CHECK_FALSE(model.updateInProgress());
+    CHECK(slow->getText() == "THROW");
+
+    slow->setDelay(0);
+    source->setText("ok");
+
+    CHECK(slow->getText() == "OK");
+}
+
+TEST_CASE("Data Flow - Propagation profiler", "[dataflow]")
+{
+    auto app = applicationSetup();
+
+    auto registry = createTestRegistry();
+    DataFlowGraphModel model(registry);
+
+    // source -> display -> sink
+    auto sourceId = model.addNode("TestSourceNode");
+    auto displayId = model.addNode("TestDisplayNode");
+    auto sinkId = model.addNode("TestMergeNode");
+
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, displayId, 0});
+    model.addConnection(QtNodes::ConnectionId{displayId, 0, sinkId, 0});
+
+    auto source = model.delegateModel<TestSourceNode>(sourceId);
+    REQUIRE(source != nullptr);
+
+    QtNodes::NodeProfiler &profiler = model.profiler();
+
+    SECTION("Nothing is recorded while disabled")
+    {
+        source->setText("abc");
+
+        CHECK(profiler.stats(displayId).invocations == 0);
+        CHECK(profiler.events().empty());
+    }
+
+    SECTION("Invocations, bytes and causes are recorded")
+    {
+        profiler.setEnabled(true);
+
+        source->setText("abc");
+        source->setText("abcd");
+
+        auto const display = profiler.stats(displayId);
+        CHECK(display.invocations == 2);
+        CHECK(display.lastCause == sourceId);
+        CHECK(display.totalNs >= display.maxNs);
+
+        // The source pushed "abc" and "abcd" without being evaluated itself.
+        CHECK(profiler.stats(sourceId).invocations == 0);
+        CHECK(profiler.stats(sourceId).bytesProduced == 7 * sizeof(QChar));
+
+        CHECK(profiler.causeChain(sinkId)
+              == std::vector<QtNodes::NodeId>{sinkId, displayId, sourceId});
+
+        QJsonArray const traceEvents = model.profileTrace()["traceEvents"].toArray();
+
+        int spans = 0;
+        for (auto const &value : traceEvents) {
+            QJsonObject const event = value.toObject();
+            if (event["ph"].toString() == "X") {
+                ++spans;
+                CHECK(event.contains("ts"));
+                CHECK(event.contains("dur"));
+            }
+        }
+        CHECK(spans == 4);
+
+        profiler.clear();
+        CHECK(profiler.allStats().empty());
+    }
+}
+
+TEST_CASE("Data Flow - Compiled execution plan", "[dataflow]")
+{
+    auto app = applicationSetup();
+
+    auto registry = createTestRegistry();
+    DataFlowGraphModel model(registry);
+
+    // source -> display -> sink
+    auto sourceId = model.addNode("TestSourceNode");
+    auto displayId = model.addNode("TestDisplayNode");
+    auto sinkId = model.addNode("TestMergeNode");
+
+    model.addConnection(QtNodes::ConnectionId{sourceId, 0, displayId, 0});
+    model.addConnection(QtNodes::ConnectionId{displayId, 0, sinkId, 0});
+
+    auto source = model.delegateModel<TestSourceNode>(sourceId);
+    auto sink = model.delegateModel<TestMergeNode>(sinkId);
+
+    REQUIRE(source != nullptr);
+    REQUIRE(sink != nullptr);
+
+    QtNodes::ExecutionPlan plan = model.compile();
+
+    REQUIRE(plan.isValid());
+    CHECK(plan.stepCount() == 3);
+
+    SECTION("A run evaluates every node once")
+    {
+        source->setText("ab");
+
+        int const sinkBefore = sink->inputCount();
+
+        CHECK(plan.run());
+
+        // Outputs reported by the nodes are not propagated a second time.
+        CHECK(sink->inputCount() - sinkBefore == 1);
+        CHECK(sink->getText() == "ab");
+
+        auto result = std::dynamic_pointer_cast<TestData>(plan.outData(sinkId, 0));
+        REQUIRE(result != nullptr);
+        CHECK(result->text() == "ab");
+    }
+
+    SECTION("Pinned source data replaces the node's output")
+    {
+        plan.setSourceData(sourceId, 0, std::make_shared<TestData>("pinned"));
+
+        CHECK(plan.run());
+        CHECK(sink->getText() == "pinned");
+
+        plan.clearSourceData();
+
+        CHECK(plan.run());
+        CHECK(sink->getText() == source->getCurrentText());
+    }
+
+    SECTION("Structural changes invalidate the plan")
+    {
+        quint64 const version = model.structureVersion();
+
+        model.addNode("TestDisplayNode");
+
+        CHECK(model.structureVersion() != version);
+        CHECK_FALSE(plan.isValid());
+        CHECK_FALSE(plan.run());
+
+        CHECK(model.compile().isValid());
+    }
+
+    SECTION("Data changes keep the plan valid")
+    {
+        source->setText("xyz");
+
+        CHECK(plan.isValid());
+    }
+}
@@ -1,6 +1,7 @@
 #include "ApplicationSetup.hpp"
 
 #include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/DataTypeRegistry>
 #include <QtNodes/NodeDelegateModel>
 #include <QtNodes/NodeDelegateModelRegistry>
 #include <QtNodes/Definitions>
@@ -9,6 +10,7 @@
 
 using QtNodes::ConnectionId;
 using QtNodes::DataFlowGraphModel;
+using QtNodes::DataTypeRegistry;
 using QtNodes::InvalidNodeId;
 using QtNodes::NodeDelegateModel;
 using QtNodes::NodeDelegateModelRegistry;
@@ -168,3 +170,215 @@ TEST_CASE("DataFlowGraphModel serialization support", "[dataflow]")
         CHECK(fullJson.contains("connections"));
     }
 }
+
+TEST_CASE("DataFlowGraphModel connection index", "[dataflow]")
+{
+    auto app = applicationSetup();
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<TestNodeDelegate>("TestNode");
+
+    DataFlowGraphModel model(registry);
+
+    NodeId node1 = model.addNode("TestNode");
+    NodeId node2 = model.addNode("TestNode");
+    NodeId node3 = model.addNode("TestNode");
+
+    ConnectionId connId12{node1, 0, node2, 0};
+    ConnectionId connId13{node1, 0, node3, 1};
+    ConnectionId connId23{node2, 0, node3, 0};
+
+    model.addConnection(connId12);
+    model.addConnection(connId13);
+    model.addConnection(connId23);
+
+    SECTION("Port and node queries reflect added connections")
+    {
+        CHECK(model.connections(node1, PortType::Out, 0).size() == 2);
+        CHECK(model.connections(node2, PortType::In, 0).count(connId12) == 1);
+        CHECK(model.connections(node2, PortType::In, 1).empty());
+        CHECK(model.connections(node3, PortType::In, 1).count(connId13) == 1);
+
+        CHECK(model.allConnectionIds(node1).size() == 2);
+        CHECK(model.allConnectionIds(node2).size() == 2);
+        CHECK(model.allConnectionIds(node3).size() == 2);
+    }
+
+    SECTION("Deleting a connection updates both endpoints")
+    {
+        CHECK(model.deleteConnection(connId12));
+
+        CHECK(model.connections(node1, PortType::Out, 0).size() == 1);
+        CHECK(model.connections(node2, PortType::In, 0).empty());
+        CHECK(model.allConnectionIds(node2).size() == 1);
+        CHECK(model.allConnectionIds(node2).count(connId23) == 1);
+    }
+
+    SECTION("Deleting a node drops all of its connections")
+    {
+        model.deleteNode(node1);
+
+        CHECK(model.allConnectionIds(node1).empty());
+        CHECK(model.connections(node2, PortType::In, 0).empty());
+        CHECK(model.connections(node3, PortType::In, 1).empty());
+        CHECK(model.allConnectionIds(node3).size() == 1);
+        CHECK(model.connectionExists(connId23));
+    }
+}
+
+TEST_CASE("DataFlowGraphModel exposes node styles directly", "[dataflow]")
+{
+    auto app = applicationSetup();
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<TestNodeDelegate>("TestNode");
+
+    DataFlowGraphModel model(registry);
+
+    NodeId nodeId = model.addNode("TestNode");
+
+    auto delegate = model.delegateModel<TestNodeDelegate>(nodeId);
+    REQUIRE(delegate != nullptr);
+
+    CHECK(model.nodeStyle(nodeId) == &delegate->nodeStyle());
+
+    delegate->setBackgroundColor(Qt::blue);
+    CHECK(model.nodeStyle(nodeId)->backgroundColor() == QColor(Qt::blue));
+
+    CHECK(model.nodeStyle(InvalidNodeId) == nullptr);
+}
+
+/// Converts "decimal" inputs into "integer" outputs.
+class TypedNodeDelegate : public TestNodeDelegate
+{
+public:
+    QString name() const override { return "TypedNode"; }
+    QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex) const override
+    {
+        if (portType == PortType::In)
+            return {"decimal", "Decimal"};
+
+        return {"integer", "Integer"};
+    }
+};
+
+class CountingTypedNodeDelegate : public TypedNodeDelegate
+{
+public:
+    QtNodes::NodeDataType dataType(QtNodes::PortType portType,
+                                   QtNodes::PortIndex portIndex) const override
+    {
+        ++dataTypeCalls;
+        return TypedNodeDelegate::dataType(portType, portIndex);
+    }
+
+    mutable int dataTypeCalls = 0;
+};
+
+TEST_CASE("Data type ids are interned", "[dataflow]")
+{
+    auto app = applicationSetup();
+
+    SECTION("Registry")
+    {
+        auto const decimal = DataTypeRegistry::intern(QString("decimal"));
+
+        CHECK(decimal != QtNodes::InvalidDataTypeHandle);
+        CHECK(DataTypeRegistry::intern(QtNodes::NodeDataType{"decimal", "Other Name"}) == decimal);
+        CHECK(DataTypeRegistry::intern(QString("integer")) != decimal);
+        CHECK(DataTypeRegistry::typeId(decimal) == "decimal");
+
+        CHECK(DataTypeRegistry::intern(QString()) == QtNodes::InvalidDataTypeHandle);
+        CHECK(DataTypeRegistry::typeId(QtNodes::InvalidDataTypeHandle).isEmpty());
+    }
+
+    SECTION("Model ports")
+    {
+        auto registry = std::make_shared<NodeDelegateModelRegistry>();
+        registry->registerModel<TypedNodeDelegate>("TypedNode");
+
+        DataFlowGraphModel model(registry);
+
+        NodeId node1 = model.addNode("TypedNode");
+        NodeId node2 = model.addNode("TypedNode");
+
+        CHECK(model.portDataTypeHandle(node1, PortType::In, 0)
+              == DataTypeRegistry::intern(QString("decimal")));
+        CHECK(model.portDataTypeHandle(node1, PortType::Out, 0)
+              == DataTypeRegistry::intern(QString("integer")));
+        CHECK(model.portDataTypeHandle(InvalidNodeId, PortType::Out, 0)
+              == QtNodes::InvalidDataTypeHandle);
+
+        // The default implementation agrees with the delegate shortcut.
+        CHECK(model.QtNodes::AbstractGraphModel::portDataTypeHandle(node1, PortType::Out, 0)
+              == model.portDataTypeHandle(node1, PortType::Out, 0));
+
+        // Output and input types differ.
+        CHECK_FALSE(model.connectionPossible(ConnectionId{node1, 0, node2, 0}));
+    }
+
+    SECTION("Delegates cache their handles")
+    {
+        CountingTypedNodeDelegate node;
+
+        auto const decimal = node.dataTypeHandle(PortType::In, 1);
+
+        CHECK(decimal == DataTypeRegistry::intern(QString("decimal")));
+        CHECK(node.dataTypeHandle(PortType::In, 1) == decimal);
+        CHECK(node.dataTypeCalls == 1);
+
+        // Status and repaint requests leave the cache alone.
+        Q_EMIT node.requestNodeUpdate();
+
+        CHECK(node.dataTypeHandle(PortType::In, 1) == decimal);
+        CHECK(node.dataTypeCalls == 1);
+
+        Q_EMIT node.portsInserted();
+
+        CHECK(node.dataTypeHandle(PortType::In, 1) == decimal);
+        CHECK(node.dataTypeCalls == 2);
+
+        node.invalidateDataTypeHandles();
+
+        CHECK(node.dataTypeHandle(PortType::In, 1) == decimal);
+        CHECK(node.dataTypeCalls == 3);
+    }
+}
+
+TEST_CASE("Typed queries agree with nodeData and portData", "[dataflow]")
+{
+    auto app = applicationSetup();
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<TypedNodeDelegate>("TypedNode");
+
+    DataFlowGraphModel model(registry);
+
+    NodeId nodeId = model.addNode("TypedNode");
+    model.setNodeData(nodeId, NodeRole::Size, QSize(120, 80));
+
+    QtNodes::AbstractGraphModel const &base = model;
+
+    for (PortType portType : {PortType::In, PortType::Out}) {
+        CHECK(model.portCount(nodeId, portType)
+              == base.AbstractGraphModel::portCount(nodeId, portType));
+
+        for (QtNodes::PortIndex i = 0; i < model.portCount(nodeId, portType); ++i) {
+            CHECK(model.portCaption(nodeId, portType, i)
+                  == base.AbstractGraphModel::portCaption(nodeId, portType, i));
+            CHECK(model.portCaptionVisible(nodeId, portType, i)
+                  == base.AbstractGraphModel::portCaptionVisible(nodeId, portType, i));
+            CHECK(model.portDataType(nodeId, portType, i).id
+                  == base.AbstractGraphModel::portDataType(nodeId, portType, i).id);
+        }
+    }
+
+    CHECK(model.portCount(nodeId, PortType::In) == 2);
+    CHECK(model.nodeSize(nodeId) == QSize(120, 80));
+    CHECK(model.nodeSize(nodeId) == base.AbstractGraphModel::nodeSize(nodeId));
+    CHECK(model.nodeCaption(nodeId) == base.AbstractGraphModel::nodeCaption(nodeId));
+    CHECK(model.nodeCaptionVisible(nodeId) == base.AbstractGraphModel::nodeCaptionVisible(nodeId));
+    CHECK(model.nodeWidget(nodeId) == base.AbstractGraphModel::nodeWidget(nodeId));
+
+    // Unknown nodes answer with empty values instead of throwing.
+    CHECK(model.portCount(InvalidNodeId, PortType::In) == 0);
+    CHECK(model.nodeSize(InvalidNodeId) == QSize());
+    CHECK(model.nodeWidget(InvalidNodeId) == nullptr);
+}
@@ -6,11 +6,13 @@
 
 #include <QtNodes/DataFlowGraphModel>
 #include <QtNodes/NodeDelegateModelRegistry>
+#include <QtNodes/internal/TopologicalOrder.hpp>
 
 using QtNodes::ConnectionId;
 using QtNodes::DataFlowGraphModel;
 using QtNodes::NodeDelegateModelRegistry;
 using QtNodes::NodeId;
+using QtNodes::TopologicalOrder;
 
 /// Test model that allows loops (default behavior)
 class LoopEnabledModel : public TestGraphModel
@@ -166,3 +168,100 @@ TEST_CASE("Loop-disabled model prevents cycles", "[loops]")
         CHECK(model.loopsEnabled() == false);
     }
 }
+
+TEST_CASE("TopologicalOrder incremental maintenance", "[loops]")
+{
+    TopologicalOrder order;
+
+    for (NodeId id = 0; id < 4; ++id)
+        order.addNode(id);
+
+    SECTION("Edges against the insertion order are reordered")
+    {
+        order.addEdge(3, 2);
+        order.addEdge(2, 1);
+        order.addEdge(1, 0);
+
+        CHECK(order.isValid());
+        CHECK(order.rank(3) < order.rank(2));
+        CHECK(order.rank(2) < order.rank(1));
+        CHECK(order.rank(1) < order.rank(0));
+
+        CHECK(order.wouldCreateCycle(0, 3));
+        CHECK(order.wouldCreateCycle(1, 1));
+        CHECK_FALSE(order.wouldCreateCycle(3, 0));
+    }
+
+    SECTION("Parallel edges are counted")
+    {
+        order.addEdge(0, 1);
+        order.addEdge(0, 1);
+        order.removeEdge(0, 1);
+
+        CHECK(order.wouldCreateCycle(1, 0));
+
+        order.removeEdge(0, 1);
+
+        CHECK_FALSE(order.wouldCreateCycle(1, 0));
+    }
+
+    SECTION("Forced cycle invalidates the order until it is broken")
+    {
+        order.addEdge(0, 1);
+        order.addEdge(1, 2);
+        order.addEdge(2, 0);
+
+        CHECK_FALSE(order.isValid());
+        CHECK(order.wouldCreateCycle(0, 2));
+
+        order.removeEdge(2, 0);
+
+        CHECK(order.isValid());
+        CHECK(order.rank(0) < order.rank(1));
+        CHECK(order.rank(1) < order.rank(2));
+    }
+
+    SECTION("Removing a node drops its edges")
+    {
+        order.addEdge(0, 1);
+        order.addEdge(1, 2);
+        order.removeNode(1);
+
+        CHECK_FALSE(order.hasNode(1));
+        CHECK_FALSE(order.wouldCreateCycle(2, 0));
+    }
+}
+
+TEST_CASE("Loop detection on diamond chains", "[loops]")
+{
+    auto app = applicationSetup();
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<TestDisplayNode>("Sinks");
+
+    DataFlowGraphModel model(registry);
+
+    // A chain of diamonds has 2^n distinct paths from the first to the last
+    // node; a traversal without a visited set would not finish here.
+    int const diamonds = 40;
+
+    NodeId top = model.addNode("TestDisplayNode");
+    NodeId const first = top;
+
+    for (int i = 0; i < diamonds; ++i) {
+        NodeId left = model.addNode("TestDisplayNode");
+        NodeId right = model.addNode("TestDisplayNode");
+        NodeId bottom = model.addNode("TestDisplayNode");
+
+        model.addConnection(ConnectionId{top, 0, left, 0});
+        model.addConnection(ConnectionId{top, 0, right, 0});
+
+        // Both branches merge into the single input of `bottom`; addConnection
+        // does not enforce the port policy.
+        model.addConnection(ConnectionId{left, 0, bottom, 0});
+        model.addConnection(ConnectionId{right, 0, bottom, 0});
+
+        top = bottom;
+    }
+
+    CHECK_FALSE(model.connectionPossible(ConnectionId{top, 0, first, 0}));
+}
@@ -11,6 +11,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QPointF>
+#include <QBuffer>
 
 using QtNodes::ConnectionId;
 using QtNodes::DataFlowGraphModel;
@@ -36,6 +37,23 @@ public:
     QWidget* embeddedWidget() override { return nullptr; }
 };
 
+class ParameterTestModel : public SerializableTestModel
+{
+public:
+    QString name() const override { return "ParameterTestModel"; }
+
+    QJsonObject save() const override
+    {
+        QJsonObject json = NodeDelegateModel::save();
+        json["value"] = _value;
+        return json;
+    }
+
+    void load(QJsonObject const &json) override { _value = json["value"].toString(); }
+
+    QString _value;
+};
+
 TEST_CASE("DataFlowGraphModel serialization", "[serialization]")
 {
     auto app = applicationSetup();
@@ -158,3 +176,172 @@ TEST_CASE("Individual node serialization", "[serialization]")
         CHECK(nodeJson.contains("position"));
     }
 }
+
+TEST_CASE("Binary serialization", "[serialization]")
+{
+    auto app = applicationSetup();
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<SerializableTestModel>("SerializableTestModel");
+    registry->registerModel<ParameterTestModel>("ParameterTestModel");
+
+    DataFlowGraphModel model(registry);
+
+    NodeId node1 = model.addNode("SerializableTestModel");
+    NodeId node2 = model.addNode("ParameterTestModel");
+    model.setNodeData(node1, NodeRole::Position, QPointF(10.5, -20));
+    model.setNodeData(node2, NodeRole::Position, QPointF(300, 400));
+    model.delegateModel<ParameterTestModel>(node2)->_value = "custom";
+
+    ConnectionId conn{node1, 0, node2, 0};
+    model.addConnection(conn);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    REQUIRE(model.saveBinary(buffer));
+
+    SECTION("Round trip restores nodes, positions, internal data and connections")
+    {
+        buffer.seek(0);
+        CHECK(DataFlowGraphModel::isBinaryFormat(buffer));
+        CHECK(buffer.pos() == 0);
+
+        DataFlowGraphModel newModel(registry);
+        REQUIRE(newModel.loadBinary(buffer));
+
+        CHECK(newModel.allNodeIds() == model.allNodeIds());
+        CHECK(newModel.nodeData(node1, NodeRole::Position).toPointF() == QPointF(10.5, -20));
+        CHECK(newModel.nodeData(node2, NodeRole::Position).toPointF() == QPointF(300, 400));
+        CHECK(newModel.delegateModel<ParameterTestModel>(node2)->_value == "custom");
+        CHECK(newModel.connectionExists(conn));
+
+        // Fresh ids do not clash with the restored ones.
+        NodeId node3 = newModel.addNode("SerializableTestModel");
+        CHECK(node3 != node1);
+        CHECK(node3 != node2);
+    }
+
+    SECTION("JSON data is not mistaken for the binary format")
+    {
+        QBuffer jsonBuffer;
+        jsonBuffer.setData(QJsonDocument(model.save()).toJson());
+        jsonBuffer.open(QIODevice::ReadOnly);
+
+        CHECK_FALSE(DataFlowGraphModel::isBinaryFormat(jsonBuffer));
+
+        DataFlowGraphModel newModel(registry);
+        CHECK_FALSE(newModel.loadBinary(jsonBuffer));
+        CHECK(newModel.allNodeIds().empty());
+    }
+
+    SECTION("Truncated data is rejected without touching the model")
+    {
+        QBuffer truncated;
+        truncated.setData(buffer.data().left(buffer.data().size() - 1));
+        truncated.open(QIODevice::ReadOnly);
+
+        DataFlowGraphModel newModel(registry);
+        CHECK_FALSE(newModel.loadBinary(truncated));
+        CHECK(newModel.allNodeIds().empty());
+    }
+
+    SECTION("Blob sizes beyond the end of the data are rejected")
+    {
+        // The first node record follows the 16 byte header, its blob size
+        // follows the id and the position.
+        QByteArray data = buffer.data();
+        int const blobSizeOffset = 16 + 4 + 8 + 8;
+        for (int i = 0; i < 4; ++i)
+            data[blobSizeOffset + i] = static_cast<char>(0xff);
+
+        QBuffer corrupt;
+        corrupt.setData(data);
+        corrupt.open(QIODevice::ReadOnly);
+
+        DataFlowGraphModel newModel(registry);
+        CHECK_FALSE(newModel.loadBinary(corrupt));
+        CHECK(newModel.allNodeIds().empty());
+
+        corrupt.seek(0);
+        CHECK_FALSE(newModel.loadIncrementally(corrupt));
+        CHECK(newModel.allNodeIds().empty());
+    }
+
+    SECTION("A damaged node state is not restored as a default node")
+    {
+        DataFlowGraphModel newModel(registry);
+
+        CHECK_THROWS(newModel.restoreNodeState(node1, QPointF(), QByteArray("\xff\xff\xff", 3)));
+        CHECK_FALSE(newModel.nodeExists(node1));
+    }
+}
+
+TEST_CASE("Incremental loading", "[serialization]")
+{
+    auto app = applicationSetup();
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<SerializableTestModel>("SerializableTestModel");
+    registry->registerModel<ParameterTestModel>("ParameterTestModel");
+
+    DataFlowGraphModel model(registry);
+
+    std::vector<NodeId> nodes;
+    for (int i = 0; i < 10; ++i) {
+        nodes.push_back(model.addNode("ParameterTestModel"));
+        model.delegateModel<ParameterTestModel>(nodes.back())->_value = QString::number(i);
+    }
+
+    for (std::size_t i = 1; i < nodes.size(); ++i)
+        model.addConnection(ConnectionId{nodes[i - 1], 0, nodes[i], 0});
+
+    std::size_t const total = nodes.size() * 2 - 1;
+
+    auto checkRestored = [&](DataFlowGraphModel &restored) {
+        CHECK(restored.allNodeIds() == model.allNodeIds());
+        CHECK(restored.delegateModel<ParameterTestModel>(nodes[7])->_value == "7");
+        CHECK(restored.connectionExists(ConnectionId{nodes[3], 0, nodes[4], 0}));
+    };
+
+    std::vector<std::size_t> reports;
+    auto progress = [&reports](std::size_t done, std::size_t all) {
+        CHECK(done <= all);
+        reports.push_back(done);
+    };
+
+    SECTION("Binary data")
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        REQUIRE(model.saveBinary(buffer));
+        buffer.seek(0);
+
+        DataFlowGraphModel restored(registry);
+        REQUIRE(restored.loadIncrementally(buffer, progress, 4));
+
+        checkRestored(restored);
+        CHECK(reports == std::vector<std::size_t>{4, 8, 12, 16, total});
+    }
+
+    SECTION("JSON data")
+    {
+        QBuffer buffer;
+        buffer.setData(QJsonDocument(model.save()).toJson());
+        buffer.open(QIODevice::ReadOnly);
+
+        DataFlowGraphModel restored(registry);
+        REQUIRE(restored.loadIncrementally(buffer, progress, 4));
+
+        checkRestored(restored);
+        CHECK(reports == std::vector<std::size_t>{4, 8, 12, 16, total});
+    }
+
+    SECTION("Malformed data")
+    {
+        QBuffer buffer;
+        buffer.setData("{ not json");
+        buffer.open(QIODevice::ReadOnly);
+
+        DataFlowGraphModel restored(registry);
+        CHECK_FALSE(restored.loadIncrementally(buffer, progress));
+        CHECK(restored.allNodeIds().empty());
+    }
+}
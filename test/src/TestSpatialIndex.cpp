@@ -0,0 +1,116 @@
+#include "ApplicationSetup.hpp"
+#include "TestGraphModel.hpp"
+
+#include <QtNodes/BasicGraphicsScene>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
+#include <QtNodes/internal/SceneSpatialIndex.hpp>
+#include <QtNodes/internal/locateNode.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+using QtNodes::BasicGraphicsScene;
+using QtNodes::ConnectionId;
+using QtNodes::NodeId;
+using QtNodes::NodeRole;
+using QtNodes::SceneSpatialIndex;
+
+template<typename Id>
+static bool contains(std::vector<Id> const &ids, Id const &id)
+{
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+TEST_CASE("SceneSpatialIndex queries", "[graphics][spatial]")
+{
+    SceneSpatialIndex index(100.0);
+
+    index.updateNode(1, QRectF(10, 10, 50, 50));
+    index.updateNode(2, QRectF(150, 150, 120, 80));
+    index.updateNode(3, QRectF(-500, -500, 40, 40));
+
+    SECTION("Point queries")
+    {
+        CHECK(index.nodesAt(QPointF(20, 20)) == std::vector<NodeId>{1});
+        CHECK(index.nodesAt(QPointF(260, 220)) == std::vector<NodeId>{2});
+        CHECK(index.nodesAt(QPointF(-480, -480)) == std::vector<NodeId>{3});
+        CHECK(index.nodesAt(QPointF(100, 100)).empty());
+    }
+
+    SECTION("Items spanning several cells are reported once")
+    {
+        auto nodes = index.nodesIn(QRectF(0, 0, 300, 300));
+
+        CHECK(nodes.size() == 2);
+        CHECK(contains(nodes, NodeId(1)));
+        CHECK(contains(nodes, NodeId(2)));
+    }
+
+    SECTION("Moves and removals")
+    {
+        index.updateNode(1, QRectF(15, 15, 50, 50));
+        CHECK(index.nodesAt(QPointF(62, 62)) == std::vector<NodeId>{1});
+
+        index.updateNode(1, QRectF(1000, 1000, 50, 50));
+        CHECK(index.nodesAt(QPointF(20, 20)).empty());
+        CHECK(index.nodesAt(QPointF(1010, 1010)) == std::vector<NodeId>{1});
+
+        index.removeNode(2);
+        CHECK(index.nodeCount() == 2);
+        CHECK(index.nodesAt(QPointF(200, 200)).empty());
+    }
+
+    SECTION("Oversized connections")
+    {
+        ConnectionId longConnection{1, 0, 3, 0};
+        ConnectionId shortConnection{1, 0, 2, 0};
+
+        index.updateConnection(longConnection, QRectF(-10000, -10000, 20000, 20000));
+        index.updateConnection(shortConnection, QRectF(50, 50, 120, 120));
+
+        auto connections = index.connectionsIn(QRectF(60, 60, 10, 10));
+        CHECK(connections.size() == 2);
+
+        CHECK(index.connectionsIn(QRectF(5000, 5000, 10, 10))
+              == std::vector<ConnectionId>{longConnection});
+
+        index.removeConnection(longConnection);
+        CHECK(index.connectionsIn(QRectF(5000, 5000, 10, 10)).empty());
+    }
+}
+
+TEST_CASE("BasicGraphicsScene keeps the spatial index up to date", "[graphics][spatial]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    NodeId node1 = model.addNode("Node1");
+    NodeId node2 = model.addNode("Node2");
+    model.setNodeData(node1, NodeRole::Position, QPointF(0, 0));
+    model.setNodeData(node2, NodeRole::Position, QPointF(1000, 0));
+
+    ConnectionId connId{node1, 0, node2, 0};
+    model.addConnection(connId);
+
+    auto &index = scene.spatialIndex();
+
+    CHECK(index.nodeCount() == 2);
+    CHECK(index.connectionCount() == 1);
+
+    QPointF const center1 = scene.nodeGraphicsObject(node1)->sceneBoundingRect().center();
+    CHECK(QtNodes::locateNodeAt(center1, scene, QTransform()) == scene.nodeGraphicsObject(node1));
+
+    model.setNodeData(node1, NodeRole::Position, QPointF(5000, 5000));
+
+    CHECK(QtNodes::locateNodeAt(center1, scene, QTransform()) == nullptr);
+
+    QPointF const moved = scene.nodeGraphicsObject(node1)->sceneBoundingRect().center();
+    CHECK(QtNodes::locateNodeAt(moved, scene, QTransform()) == scene.nodeGraphicsObject(node1));
+
+    model.deleteNode(node1);
+
+    CHECK(index.nodeCount() == 1);
+    CHECK(index.connectionCount() == 0);
+}
@@ -162,6 +162,26 @@ TEST_CASE("UI Interaction - Node Movement", "[ui][visual]")
         // Verify UI doesn't crash
         CHECK(model->allNodeIds().size() == 2);
     }
+
+    SECTION("Shift rubber band selects the nodes it covers")
+    {
+        NodeId inside = model->addNode("TestNode");
+        NodeId outside = model->addNode("TestNode");
+
+        model->setNodeData(inside, NodeRole::Position, QPointF(50, 50));
+        model->setNodeData(outside, NodeRole::Position, QPointF(600, 50));
+        UITestHelper::waitForUI();
+
+        QTest::keyPress(&view, Qt::Key_Shift);
+
+        UITestHelper::simulateMouseDrag(&view, QPointF(0, 0), QPointF(300, 300));
+        UITestHelper::waitForUI();
+
+        QTest::keyRelease(&view, Qt::Key_Shift);
+
+        CHECK(scene.nodeGraphicsObject(inside)->isSelected());
+        CHECK_FALSE(scene.nodeGraphicsObject(outside)->isSelected());
+    }
 }
 
 TEST_CASE("UI Interaction - Connection Creation", "[ui][visual]")
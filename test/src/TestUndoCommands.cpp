@@ -1,18 +1,41 @@
 #include "ApplicationSetup.hpp"
+#include "TestDataFlowNodes.hpp"
 #include "TestGraphModel.hpp"
 
 #include <QtNodes/BasicGraphicsScene>
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/NodeDelegateModelRegistry>
+#include <QtNodes/UndoCommands>
+#include <QtNodes/UndoHistory>
+#include <QtNodes/internal/ConnectionGraphicsObject.hpp>
+#include <QtNodes/internal/NodeGraphicsObject.hpp>
 #include <QtNodes/Definitions>
 
 #include <catch2/catch.hpp>
 
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMimeData>
+#include <QSignalSpy>
 #include <QUndoStack>
 
+#include <memory>
+#include <unordered_set>
+
 using QtNodes::BasicGraphicsScene;
 using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::DeleteCommand;
 using QtNodes::InvalidNodeId;
+using QtNodes::NodeDelegateModelRegistry;
 using QtNodes::NodeId;
 using QtNodes::NodeRole;
+using QtNodes::PasteCommand;
+using QtNodes::UndoHistory;
 
 TEST_CASE("UndoStack integration with BasicGraphicsScene", "[undo]")
 {
@@ -96,3 +119,298 @@ TEST_CASE("Manual undo/redo simulation", "[undo]")
         CHECK(model.connectionExists(connId));
     }
 }
+
+TEST_CASE("Node drag gesture creates one undo command", "[undo]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    NodeId node1 = model.addNode("Node1");
+    NodeId node2 = model.addNode("Node2");
+    NodeId node3 = model.addNode("Node3");
+
+    model.setNodeData(node1, NodeRole::Position, QPointF(0, 0));
+    model.setNodeData(node2, NodeRole::Position, QPointF(200, 0));
+    model.setNodeData(node3, NodeRole::Position, QPointF(400, 0));
+
+    ConnectionId connId{node2, 0, node3, 0};
+    model.addConnection(connId);
+
+    auto cgo = scene.connectionGraphicsObject(connId);
+    REQUIRE(cgo != nullptr);
+    QPointF const outEnd = cgo->mapToScene(cgo->endPoint(QtNodes::PortType::Out));
+
+    scene.nodeGraphicsObject(node1)->setSelected(true);
+    scene.nodeGraphicsObject(node2)->setSelected(true);
+
+    auto &undoStack = scene.undoStack();
+    int const initialCount = undoStack.count();
+
+    scene.beginNodeDrag();
+    CHECK(scene.nodeDragInProgress());
+
+    for (int i = 0; i < 10; ++i)
+        scene.dragNodes(QPointF(5, 1));
+
+    // The model is untouched until the gesture ends.
+    CHECK(model.nodeData(node2, NodeRole::Position).toPointF() == QPointF(200, 0));
+    CHECK(scene.nodeGraphicsObject(node2)->pos() == QPointF(250, 10));
+    CHECK(cgo->mapToScene(cgo->endPoint(QtNodes::PortType::Out)) == outEnd + QPointF(50, 10));
+    CHECK(undoStack.count() == initialCount);
+
+    scene.endNodeDrag();
+
+    CHECK_FALSE(scene.nodeDragInProgress());
+    CHECK(undoStack.count() == initialCount + 1);
+    CHECK(model.nodeData(node1, NodeRole::Position).toPointF() == QPointF(50, 10));
+    CHECK(model.nodeData(node2, NodeRole::Position).toPointF() == QPointF(250, 10));
+    CHECK(model.nodeData(node3, NodeRole::Position).toPointF() == QPointF(400, 0));
+
+    undoStack.undo();
+
+    CHECK(model.nodeData(node1, NodeRole::Position).toPointF() == QPointF(0, 0));
+    CHECK(scene.nodeGraphicsObject(node2)->pos() == QPointF(200, 0));
+    CHECK(cgo->mapToScene(cgo->endPoint(QtNodes::PortType::Out)) == outEnd);
+
+    SECTION("Gestures are undone one at a time")
+    {
+        undoStack.redo();
+
+        scene.beginNodeDrag();
+        scene.dragNodes(QPointF(10, 0));
+        scene.endNodeDrag();
+
+        CHECK(undoStack.count() == initialCount + 2);
+
+        undoStack.undo();
+        CHECK(model.nodeData(node2, NodeRole::Position).toPointF() == QPointF(250, 10));
+    }
+
+    SECTION("Deleting a dragged node cancels the gesture")
+    {
+        scene.beginNodeDrag();
+        scene.dragNodes(QPointF(30, 0));
+
+        model.deleteNode(node1);
+
+        CHECK_FALSE(scene.nodeDragInProgress());
+        CHECK(undoStack.count() == initialCount + 1);
+        CHECK(scene.nodeGraphicsObject(node2)->pos() == QPointF(200, 0));
+        CHECK(cgo->mapToScene(cgo->endPoint(QtNodes::PortType::Out)) == outEnd);
+
+        // The next gesture collects the selection afresh.
+        QPointF const inEnd = cgo->mapToScene(cgo->endPoint(QtNodes::PortType::In));
+
+        scene.nodeGraphicsObject(node3)->setSelected(true);
+        scene.beginNodeDrag();
+        scene.dragNodes(QPointF(0, 20));
+        scene.endNodeDrag();
+
+        CHECK(model.nodeData(node3, NodeRole::Position).toPointF() == QPointF(400, 20));
+        CHECK(cgo->mapToScene(cgo->endPoint(QtNodes::PortType::In)) == inEnd + QPointF(0, 20));
+
+        // Connections follow moves made outside a gesture again.
+        undoStack.undo();
+        CHECK(cgo->mapToScene(cgo->endPoint(QtNodes::PortType::In)) == inEnd);
+    }
+
+    SECTION("A model reset cancels the gesture")
+    {
+        scene.beginNodeDrag();
+        scene.dragNodes(QPointF(30, 0));
+
+        Q_EMIT model.modelReset();
+
+        CHECK_FALSE(scene.nodeDragInProgress());
+        CHECK(undoStack.count() == initialCount + 1);
+    }
+}
+
+TEST_CASE("Deleted nodes are restored from compact state", "[undo]")
+{
+    auto app = applicationSetup();
+
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<TestSourceNode>();
+    registry->registerModel<TestDisplayNode>();
+
+    DataFlowGraphModel model(registry);
+    BasicGraphicsScene scene(model);
+
+    NodeId source = model.addNode("TestSourceNode");
+    NodeId display = model.addNode("TestDisplayNode");
+
+    model.setNodeData(source, NodeRole::Position, QPointF(10, 20));
+    model.setNodeData(display, NodeRole::Position, QPointF(300, 20));
+
+    ConnectionId connId{source, 0, display, 0};
+    model.addConnection(connId);
+
+    CHECK_FALSE(model.saveNodeState(source).isEmpty());
+
+    scene.nodeGraphicsObject(source)->setSelected(true);
+    scene.nodeGraphicsObject(display)->setSelected(true);
+
+    scene.undoStack().push(new DeleteCommand(&scene));
+
+    CHECK(model.allNodeIds().empty());
+
+    scene.undoStack().undo();
+
+    REQUIRE(model.nodeExists(source));
+    REQUIRE(model.nodeExists(display));
+    CHECK(model.nodeData(source, NodeRole::Type).toString() == "TestSourceNode");
+    CHECK(model.nodeData(display, NodeRole::Position).toPointF() == QPointF(300, 20));
+    CHECK(model.connectionExists(connId));
+    CHECK(model.allConnectionIds(display).size() == 1);
+    CHECK(scene.nodeGraphicsObject(source) != nullptr);
+
+    scene.undoStack().redo();
+
+    CHECK(model.allNodeIds().empty());
+}
+
+TEST_CASE("A failed paste leaves no nodes behind", "[undo]")
+{
+    auto app = applicationSetup();
+
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<TestSourceNode>();
+
+    DataFlowGraphModel model(registry);
+    BasicGraphicsScene scene(model);
+
+    NodeId const existing = model.addNode("TestSourceNode");
+
+    auto nodeJson = [](int id, QString const &modelName) {
+        QJsonObject internalData;
+        internalData["model-name"] = modelName;
+
+        QJsonObject position;
+        position["x"] = 0.0;
+        position["y"] = 0.0;
+
+        QJsonObject node;
+        node["id"] = id;
+        node["position"] = position;
+        node["internal-data"] = internalData;
+
+        return node;
+    };
+
+    // The second node cannot be restored after the first one was.
+    QJsonObject sceneJson;
+    sceneJson["nodes"] = QJsonArray{nodeJson(1, "TestSourceNode"),
+                                    nodeJson(2, "UnregisteredNode")};
+    sceneJson["connections"] = QJsonArray();
+
+    auto mimeData = new QMimeData;
+    mimeData->setData("application/qt-nodes-graph",
+                      QJsonDocument(sceneJson).toJson(QJsonDocument::Compact));
+    QApplication::clipboard()->setMimeData(mimeData);
+
+    auto &undoStack = scene.undoStack();
+    int const initialCount = undoStack.count();
+
+    undoStack.push(new PasteCommand(&scene, QPointF(100, 100)));
+
+    CHECK(model.allNodeIds() == std::unordered_set<NodeId>{existing});
+    CHECK(scene.selectedItems().isEmpty());
+    CHECK(undoStack.count() == initialCount);
+}
+
+TEST_CASE("Undo history stays within its memory limit", "[undo]")
+{
+    auto app = applicationSetup();
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    auto &undoStack = scene.undoStack();
+    auto &history = scene.undoHistory();
+
+    NodeId nodeId = model.addNode("Node");
+    model.setNodeData(nodeId, NodeRole::Position, QPointF(0, 0));
+    scene.nodeGraphicsObject(nodeId)->setSelected(true);
+
+    auto drag = [&scene]() {
+        scene.beginNodeDrag();
+        scene.dragNodes(QPointF(10, 0));
+        scene.endNodeDrag();
+    };
+
+    CHECK(history.memoryLimit() == 0);
+    CHECK(history.memoryUsage() == 0);
+
+    drag();
+    drag();
+
+    std::size_t const twoCommands = history.memoryUsage();
+    CHECK(twoCommands > 0);
+    CHECK(history.evictedCount() == 0);
+
+    SECTION("Usage follows the stack")
+    {
+        drag();
+        CHECK(history.memoryUsage() > twoCommands);
+
+        undoStack.clear();
+        CHECK(history.memoryUsage() == 0);
+    }
+
+    SECTION("The oldest commands are evicted")
+    {
+        history.setMemoryLimit(1);
+
+        drag();
+
+        CHECK(history.evictedCount() == 2);
+        CHECK(history.memoryUsage() > 0);
+        CHECK(history.memoryUsage() < twoCommands);
+
+        // The most recent command is kept.
+        undoStack.undo();
+        CHECK(model.nodeData(nodeId, NodeRole::Position).toPointF() == QPointF(20, 0));
+
+        // Evicted commands are dropped without being undone.
+        undoStack.undo();
+        undoStack.undo();
+        CHECK(model.nodeData(nodeId, NodeRole::Position).toPointF() == QPointF(20, 0));
+        CHECK_FALSE(undoStack.canUndo());
+    }
+
+    SECTION("Undo stops at the evicted commands")
+    {
+        std::unique_ptr<QAction> undoAction(history.createUndoAction(nullptr));
+        QSignalSpy canUndoSpy(&history, &UndoHistory::canUndoChanged);
+
+        history.setMemoryLimit(1);
+
+        drag();
+
+        CHECK(history.undoBoundary() == 2);
+        CHECK(history.canUndo());
+        CHECK(undoAction->isEnabled());
+
+        undoAction->trigger();
+
+        CHECK(model.nodeData(nodeId, NodeRole::Position).toPointF() == QPointF(20, 0));
+        CHECK(undoStack.index() == 2);
+        CHECK_FALSE(history.canUndo());
+        CHECK_FALSE(undoAction->isEnabled());
+        CHECK(canUndoSpy.count() == 1);
+
+        // The stack alone would still offer the evicted commands.
+        CHECK(undoStack.canUndo());
+
+        history.undo();
+        undoAction->trigger();
+
+        CHECK(undoStack.index() == 2);
+
+        undoStack.redo();
+
+        CHECK(model.nodeData(nodeId, NodeRole::Position).toPointF() == QPointF(30, 0));
+        CHECK(undoAction->isEnabled());
+    }
+}
@@ -7,6 +7,8 @@
 #include <QtNodes/internal/GraphicsView.hpp>
 #include <QtNodes/internal/NodeGraphicsObject.hpp>
 
+#include <QImage>
+#include <QPainter>
 #include <QSignalSpy>
 #include <QTest>
 
@@ -203,3 +205,64 @@ TEST_CASE("Zoom fit operations", "[zoom]")
         CHECK(view.getScale() > 0);
     }
 }
+
+TEST_CASE("Level of detail follows the zoom", "[zoom]")
+{
+    auto app = applicationSetup();
+
+    TestGraphModel model;
+    BasicGraphicsScene scene(model);
+
+    using QtNodes::LevelOfDetail;
+
+    SECTION("Default thresholds")
+    {
+        CHECK(scene.levelOfDetail(QTransform::fromScale(1.0, 1.0)) == LevelOfDetail::Full);
+        CHECK(scene.levelOfDetail(QTransform::fromScale(0.5, 0.5)) == LevelOfDetail::Simplified);
+        CHECK(scene.levelOfDetail(QTransform::fromScale(0.3, 0.3)) == LevelOfDetail::Outline);
+    }
+
+    SECTION("Custom thresholds")
+    {
+        scene.setLevelOfDetailThresholds(0.2, 0.1);
+
+        CHECK(scene.levelOfDetail(QTransform::fromScale(0.3, 0.3)) == LevelOfDetail::Full);
+        CHECK(scene.levelOfDetail(QTransform::fromScale(0.15, 0.15)) == LevelOfDetail::Simplified);
+        CHECK(scene.levelOfDetail(QTransform::fromScale(0.05, 0.05)) == LevelOfDetail::Outline);
+    }
+
+    SECTION("Node widgets follow the most detailed view")
+    {
+        GraphicsView closeView(&scene);
+        GraphicsView farView(&scene);
+
+        farView.setupScale(0.35);
+        CHECK(scene.nodeWidgetsVisible());
+
+        closeView.setupScale(0.35);
+        CHECK_FALSE(scene.nodeWidgetsVisible());
+
+        farView.setupScale(1.0);
+        CHECK(scene.nodeWidgetsVisible());
+    }
+
+    SECTION("Every tier renders")
+    {
+        NodeId node1 = model.addNode("Node1");
+        NodeId node2 = model.addNode("Node2");
+        model.setNodeData(node2, NodeRole::Position, QPointF(300, 0));
+        model.addConnection(QtNodes::ConnectionId{node1, 0, node2, 0});
+
+        for (double const scale : {1.0, 0.5, 0.3}) {
+            QImage image(400, 200, QImage::Format_ARGB32);
+            image.fill(Qt::transparent);
+
+            QPainter painter(&image);
+            painter.scale(scale, scale);
+            scene.render(&painter, QRectF(), scene.itemsBoundingRect());
+            painter.end();
+
+            CHECK_FALSE(image.isNull());
+        }
+    }
+}
@@ -0,0 +1,456 @@
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/NodeDelegateModelRegistry>
+#include <QtNodes/NodeRegistryPlugin>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QLibrary>
+#include <QtCore/QThreadPool>
+#include <QtWidgets/QApplication>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <set>
+#include <vector>
+
+using QtNodes::ComputeTask;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeData;
+using QtNodes::NodeDelegateModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
+using QtNodes::NodeProcessingStatus;
+using QtNodes::NodeRole;
+using QtNodes::PortIndex;
+using QtNodes::PortRole;
+using QtNodes::PortType;
+
+namespace {
+
+/// `--set <node>:<key>=<value>`
+struct Override
+{
+    NodeId nodeId;
+    QString key;
+    QString value;
+};
+
+bool parseOverride(QString const &text, Override &result)
+{
+    int const colon = text.indexOf(':');
+    int const equals = text.indexOf('=', colon + 1);
+
+    if (colon <= 0 || equals <= colon + 1)
+        return false;
+
+    bool ok = false;
+    result.nodeId = text.left(colon).toUInt(&ok);
+    result.key = text.mid(colon + 1, equals - colon - 1);
+    result.value = text.mid(equals + 1);
+
+    return ok;
+}
+
+/// Converts `text` to the type of the value it replaces.
+QJsonValue convertValue(QJsonValue const &previous, QString const &text)
+{
+    switch (previous.type()) {
+    case QJsonValue::Bool:
+        return text == QLatin1String("true") || text == QLatin1String("1");
+
+    case QJsonValue::Double:
+        return text.toDouble();
+
+    case QJsonValue::String:
+        return text;
+
+    default:
+        break;
+    }
+
+    // New keys, arrays and objects are given as JSON.
+    QJsonDocument const doc = QJsonDocument::fromJson(QStringLiteral("[%1]").arg(text).toUtf8());
+
+    if (doc.isArray() && doc.array().size() == 1)
+        return doc.array().at(0);
+
+    return text;
+}
+
+bool loadPlugin(QString const &path, NodeDelegateModelRegistry &registry)
+{
+    // The library stays loaded, the registry keeps its model creators.
+    QLibrary library(path);
+
+    auto registerModels = reinterpret_cast<QtNodes::RegistryPluginFunction>(
+        library.resolve(QtNodes::RegistryPluginEntryPoint));
+
+    if (!registerModels) {
+        qCritical().noquote() << library.errorString();
+        return false;
+    }
+
+    registerModels(registry);
+
+    return true;
+}
+
+std::vector<NodeId> sortedNodeIds(DataFlowGraphModel const &model)
+{
+    auto const ids = model.allNodeIds();
+
+    std::vector<NodeId> result(ids.begin(), ids.end());
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+/// Makes the given nodes push all their outputs again.
+void evaluate(DataFlowGraphModel &model, std::set<NodeId> const &sources)
+{
+    model.beginUpdate();
+
+    for (NodeId const nodeId : sources) {
+        auto *delegate = model.delegateModel<NodeDelegateModel>(nodeId);
+
+        for (PortIndex i = 0; i < delegate->nPorts(PortType::Out); ++i)
+            Q_EMIT delegate->dataUpdated(i);
+    }
+
+    model.endUpdate();
+}
+
+/// Processes events until no node has an asynchronous computation running.
+void waitForComputations(DataFlowGraphModel &model, std::vector<NodeId> const &nodeIds)
+{
+    auto busy = [&]() {
+        for (NodeId const nodeId : nodeIds) {
+            ComputeTask const task = model.delegateModel<NodeDelegateModel>(nodeId)
+                                         ->currentCompute();
+
+            // The handle is reset once the result has been published.
+            if (task.isValid() && !task.isCancelled())
+                return true;
+        }
+        return false;
+    };
+
+    while (busy())
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+}
+
+QJsonObject portOutput(DataFlowGraphModel const &model,
+                       NodeId const nodeId,
+                       PortType const portType,
+                       PortIndex const portIndex,
+                       std::shared_ptr<NodeData> const &data)
+{
+    QJsonObject output;
+    output["node"] = static_cast<qint64>(nodeId);
+    output["model"] = model.nodeData(nodeId, NodeRole::Type).toString();
+    output["portType"] = portType == PortType::In ? QStringLiteral("in") : QStringLiteral("out");
+    output["port"] = static_cast<qint64>(portIndex);
+
+    if (data) {
+        output["type"] = data->type().id;
+        output["value"] = data->toJson();
+    } else {
+        output["value"] = QJsonValue();
+    }
+
+    return output;
+}
+
+/**
+ * The graph's results: data arriving at nodes without outputs, and data on
+ * output ports nothing is connected to.
+ */
+QJsonArray collectOutputs(DataFlowGraphModel const &model, std::vector<NodeId> const &nodeIds)
+{
+    QJsonArray outputs;
+
+    auto producedData = [&model](NodeId const nodeId, PortIndex const portIndex) {
+        return model.portData(nodeId, PortType::Out, portIndex, PortRole::Data)
+            .value<std::shared_ptr<NodeData>>();
+    };
+
+    for (NodeId const nodeId : nodeIds) {
+        unsigned int const outPorts = model.portCount(nodeId, PortType::Out);
+
+        if (outPorts == 0) {
+            for (PortIndex i = 0; i < model.portCount(nodeId, PortType::In); ++i) {
+                for (auto const &cn : model.connections(nodeId, PortType::In, i)) {
+                    outputs.append(portOutput(model,
+                                              nodeId,
+                                              PortType::In,
+                                              i,
+                                              producedData(cn.outNodeId, cn.outPortIndex)));
+                }
+            }
+            continue;
+        }
+
+        for (PortIndex i = 0; i < outPorts; ++i) {
+            if (model.connections(nodeId, PortType::Out, i).empty())
+                outputs.append(portOutput(model, nodeId, PortType::Out, i, producedData(nodeId, i)));
+        }
+    }
+
+    return outputs;
+}
+
+bool writeJson(QString const &path, QJsonObject const &json)
+{
+    QFile file(path);
+
+    bool const opened = path.isEmpty() ? file.open(stdout, QIODevice::WriteOnly)
+                                       : file.open(QIODevice::WriteOnly);
+
+    if (!opened) {
+        qCritical().noquote() << QStringLiteral("Cannot write %1").arg(path);
+        return false;
+    }
+
+    file.write(QJsonDocument(json).toJson(QJsonDocument::Indented));
+
+    return true;
+}
+
+} // namespace
+
+/**
+ * Evaluates a saved data-flow graph without a scene:
+ *
+ *   flow_runner --plugin libcalculator_models.so --set 0:number=5 --repeat 100 scene.flow
+ *
+ * Prints the graph's outputs and timings as JSON. Returns 1 on invalid
+ * arguments or input and 2 if a node ended in NodeProcessingStatus::Failed.
+ */
+int main(int argc, char *argv[])
+{
+    // Models creating widgets outside of embeddedWidget() need QApplication.
+    bool const widgets = std::any_of(argv + 1, argv + argc, [](char const *arg) {
+        return std::strcmp(arg, "--widgets") == 0;
+    });
+
+    std::unique_ptr<QCoreApplication> app;
+    if (widgets)
+        app = std::make_unique<QApplication>(argc, argv);
+    else
+        app = std::make_unique<QCoreApplication>(argc, argv);
+
+    QCoreApplication::setApplicationName("flow_runner");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Evaluates a data-flow graph saved in JSON or binary format.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Graph file to evaluate.");
+
+    QCommandLineOption const pluginOption({"p", "plugin"},
+                                          "Library defining QT_NODES_REGISTRY_PLUGIN.",
+                                          "library");
+    QCommandLineOption const setOption({"s", "set"},
+                                       "Overrides a value of the node's saved state.",
+                                       "node:key=value");
+    QCommandLineOption const modeOption({"m", "mode"},
+                                        "Execution mode, sequential or parallel.",
+                                        "mode",
+                                        "sequential");
+    QCommandLineOption const threadsOption({"t", "threads"},
+                                           "Size of the thread pool, 0 keeps the default.",
+                                           "count",
+                                           "0");
+    QCommandLineOption const repeatOption({"r", "repeat"},
+                                          "Number of evaluations.",
+                                          "count",
+                                          "1");
+    QCommandLineOption const profileOption("profile",
+                                           "Writes a Chrome trace of the evaluations.",
+                                           "file");
+    QCommandLineOption const outputOption({"o", "output"},
+                                          "Writes the report to a file instead of stdout.",
+                                          "file");
+    QCommandLineOption const widgetsOption("widgets", "Creates a QApplication for widget models.");
+
+    parser.addOptions({pluginOption,
+                       setOption,
+                       modeOption,
+                       threadsOption,
+                       repeatOption,
+                       profileOption,
+                       outputOption,
+                       widgetsOption});
+
+    parser.process(*app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+
+    for (QString const &path : parser.values(pluginOption)) {
+        if (!loadPlugin(path, *registry))
+            return 1;
+    }
+
+    std::vector<Override> overrides;
+    for (QString const &text : parser.values(setOption)) {
+        Override o;
+        if (!parseOverride(text, o)) {
+            qCritical().noquote() << QStringLiteral("Invalid override '%1'").arg(text);
+            return 1;
+        }
+        overrides.push_back(o);
+    }
+
+    QString const mode = parser.value(modeOption);
+    if (mode != QLatin1String("sequential") && mode != QLatin1String("parallel")) {
+        qCritical().noquote() << QStringLiteral("Unknown mode '%1'").arg(mode);
+        return 1;
+    }
+
+    int const threads = parser.value(threadsOption).toInt();
+
+    int const repeat = std::max(1, parser.value(repeatOption).toInt());
+
+    DataFlowGraphModel model(registry);
+
+    // Waves run on the model's pool, asynchronous computations on the global one.
+    if (threads > 0) {
+        model.threadPool()->setMaxThreadCount(threads);
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    }
+
+    model.setExecutionMode(mode == QLatin1String("parallel")
+                               ? DataFlowGraphModel::ExecutionMode::Parallel
+                               : DataFlowGraphModel::ExecutionMode::Sequential);
+
+    QString const fileName = parser.positionalArguments().first();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical().noquote() << QStringLiteral("Cannot open %1").arg(fileName);
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        if (!model.loadIncrementally(file)) {
+            qCritical().noquote() << QStringLiteral("Malformed graph file %1").arg(fileName);
+            return 1;
+        }
+    } catch (std::exception const &e) {
+        qCritical().noquote() << e.what();
+        return 1;
+    }
+
+    std::vector<NodeId> const nodeIds = sortedNodeIds(model);
+
+    waitForComputations(model, nodeIds);
+
+    qint64 const loadNs = timer.nsecsElapsed();
+
+    for (Override const &o : overrides) {
+        auto *delegate = model.delegateModel<NodeDelegateModel>(o.nodeId);
+        if (!delegate) {
+            qCritical().noquote() << QStringLiteral("No node with id %1").arg(o.nodeId);
+            return 1;
+        }
+
+        QJsonObject state = delegate->save();
+        state[o.key] = convertValue(state[o.key], o.value);
+        delegate->load(state);
+    }
+
+    // Everything downstream of the nodes without incoming connections and of
+    // the overridden ones is evaluated again.
+    std::set<NodeId> sources;
+    for (NodeId const nodeId : nodeIds) {
+        auto const connected = model.allConnectionIds(nodeId);
+
+        bool const fed = std::any_of(connected.begin(), connected.end(), [nodeId](auto const &cn) {
+            return cn.inNodeId == nodeId;
+        });
+
+        if (!fed)
+            sources.insert(nodeId);
+    }
+
+    for (Override const &o : overrides)
+        sources.insert(o.nodeId);
+
+    if (parser.isSet(profileOption))
+        model.profiler().setEnabled(true);
+
+    std::vector<qint64> runs;
+    runs.reserve(repeat);
+
+    try {
+        for (int i = 0; i < repeat; ++i) {
+            timer.restart();
+
+            evaluate(model, sources);
+            waitForComputations(model, nodeIds);
+
+            runs.push_back(timer.nsecsElapsed());
+        }
+    } catch (std::exception const &e) {
+        qCritical().noquote() << e.what();
+        return 1;
+    }
+
+    auto ms = [](qint64 ns) { return ns / 1e6; };
+
+    std::size_t connections = 0;
+    QJsonArray failed;
+    for (NodeId const nodeId : nodeIds) {
+        for (auto const &cn : model.allConnectionIds(nodeId)) {
+            if (cn.outNodeId == nodeId)
+                ++connections;
+        }
+
+        auto *delegate = model.delegateModel<NodeDelegateModel>(nodeId);
+        if (delegate->processingStatus() == NodeProcessingStatus::Failed)
+            failed.append(static_cast<qint64>(nodeId));
+    }
+
+    qint64 total = 0;
+    for (qint64 const run : runs)
+        total += run;
+
+    QJsonObject evaluation;
+    evaluation["mode"] = mode;
+    evaluation["threads"] = model.threadPool()->maxThreadCount();
+    evaluation["runs"] = repeat;
+    evaluation["totalMs"] = ms(total);
+    evaluation["minMs"] = ms(*std::min_element(runs.begin(), runs.end()));
+    evaluation["meanMs"] = ms(total / repeat);
+    evaluation["maxMs"] = ms(*std::max_element(runs.begin(), runs.end()));
+
+    QJsonObject report;
+    report["file"] = fileName;
+    report["nodes"] = static_cast<qint64>(nodeIds.size());
+    report["connections"] = static_cast<qint64>(connections);
+    report["loadMs"] = ms(loadNs);
+    report["evaluation"] = evaluation;
+    report["outputs"] = collectOutputs(model, nodeIds);
+    report["failedNodes"] = failed;
+
+    if (parser.isSet(profileOption) && !writeJson(parser.value(profileOption), model.profileTrace()))
+        return 1;
+
+    if (!writeJson(parser.value(outputOption), report))
+        return 1;
+
+    return failed.isEmpty() ? 0 : 2;
+}